@@ -0,0 +1,292 @@
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bounded_queue.hpp"
+#include "directed_graph.hpp"
+#include "edge_list_reader.hpp"
+#include "multitree_classification.hpp"
+
+namespace FTMRClassify {
+using FTMR::TypeOfMultitree;
+
+constexpr int kNumTypes = 4;
+constexpr int kInvalidRecord = -1;
+constexpr int kUnknownRecord = -2;
+constexpr long long kEndOfStream = -1;
+
+struct Options {
+    int num_workers;
+    size_t queue_capacity;
+    // Time limit per record in milliseconds, or 0 for none.
+    int timeout;
+    std::vector<std::string> files;
+};
+
+// A parsed record and its position in the input.
+struct Job {
+    long long index;
+    FTMR::EdgeListRecord record;
+};
+
+// A TypeOfMultitree value, kInvalidRecord when classification failed, or
+// kUnknownRecord when it ran out of time.
+struct Result {
+    long long index;
+    int type;
+};
+
+/* Limits the records that have been parsed but not written yet. The output
+ * stage keeps the results that arrive ahead of a slow record until it is
+ * done, so without the window they would pile up with the input size. */
+class RecordWindow {
+   public:
+    explicit RecordWindow(size_t size) : num_free_(size) {}
+
+    // Blocks until a record may enter the pipeline.
+    void Acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        available_.wait(lock, [this]() { return num_free_ > 0; });
+        --num_free_;
+    }
+
+    void Release(size_t num_records) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            num_free_ += num_records;
+        }
+        available_.notify_one();
+    }
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable available_;
+    size_t num_free_;
+};
+
+const char* TypeName(int type) {
+    switch (type) {
+        case static_cast<int>(TypeOfMultitree::kS):
+            return "S";
+        case static_cast<int>(TypeOfMultitree::kCPNotS):
+            return "CP";
+        case static_cast<int>(TypeOfMultitree::kCVNotCP):
+            return "CV";
+        case static_cast<int>(TypeOfMultitree::kNotTractable):
+            return "Others";
+        case kUnknownRecord:
+            return "Unknown";
+        default:
+            return "Invalid";
+    }
+}
+
+/* Stage 1: reads the inputs in order and numbers the records, waiting for
+ * room in the window before each one. A malformed record is reported and
+ * skipped. Each worker gets an end-of-stream job when the inputs are
+ * exhausted. */
+void ParseStage(const std::vector<std::string>& files,
+                FTMR::BoundedQueue<Job>& jobs, RecordWindow& window,
+                int num_workers) {
+    long long index = 0;
+    auto read_all = [&](std::istream& input, const std::string& name) {
+        FTMR::EdgeListReader reader(input);
+        Job job;
+        while (true) {
+            try {
+                if (!reader.Next(job.record)) {
+                    return;
+                }
+            } catch (const std::runtime_error& error) {
+                std::cerr << name << ": " << error.what() << std::endl;
+                reader.SkipRecord();
+                continue;
+            }
+            window.Acquire();
+            job.index = index++;
+            jobs.Push(std::move(job));
+        }
+    };
+
+    if (files.empty()) {
+        read_all(std::cin, "stdin");
+    }
+    for (auto& file_name : files) {
+        if (file_name == "-") {
+            read_all(std::cin, "stdin");
+            continue;
+        }
+
+        std::ifstream file(file_name);
+        if (!file) {
+            std::cerr << file_name << ": file not found." << std::endl;
+            continue;
+        }
+        read_all(file, file_name);
+    }
+
+    for (int i = 0; i < num_workers; ++i) {
+        jobs.Push(Job{kEndOfStream, FTMR::EdgeListRecord{}});
+    }
+}
+
+/* Stage 2: classifies records until it receives an end-of-stream job, which
+ * it forwards to the output stage. */
+void ClassifyStage(FTMR::BoundedQueue<Job>& jobs,
+                   FTMR::BoundedQueue<Result>& results, int timeout) {
+    Job job;
+    while (true) {
+        jobs.Pop(job);
+        if (job.index == kEndOfStream) {
+            results.Push(Result{kEndOfStream, kInvalidRecord});
+            return;
+        }
+
+        // The conditions are only defined for multitrees, so anything else
+        // is reported as invalid instead of classified.
+        int type = kInvalidRecord;
+        try {
+            FTMR::DirectedGraph digraph(job.record.edges,
+                                        job.record.num_vertices);
+            bool is_multitree = digraph.IsMultitree();
+            if (is_multitree && timeout == 0) {
+                type = static_cast<int>(FTMR::ClassifyMultitree(
+                    job.record.edges, job.record.num_vertices));
+            } else if (is_multitree) {
+                FTMR::Budget budget{std::chrono::milliseconds(timeout)};
+                TypeOfMultitree classified_type;
+                type = FTMR::ClassifyMultitree(job.record.edges,
+                                               job.record.num_vertices, budget,
+                                               classified_type)
+                           ? static_cast<int>(classified_type)
+                           : kUnknownRecord;
+            }
+        } catch (const std::exception&) {
+        }
+        results.Push(Result{job.index, type});
+    }
+}
+
+/* Stage 3: writes the results in input order, releasing their room in the
+ * window, and prints a summary once every worker has finished. */
+void OutputStage(FTMR::BoundedQueue<Result>& results, RecordWindow& window,
+                 int num_workers) {
+    std::array<long long, kNumTypes> counts = {};
+    long long num_invalid = 0;
+    long long num_unknown = 0;
+    long long next_index = 0;
+    std::map<long long, int> pending;
+
+    int num_finished_workers = 0;
+    Result result;
+    while (num_finished_workers < num_workers) {
+        results.Pop(result);
+        if (result.index == kEndOfStream) {
+            ++num_finished_workers;
+            continue;
+        }
+
+        pending[result.index] = result.type;
+        long long first_index = next_index;
+        for (auto itr = pending.begin();
+             itr != pending.end() && itr->first == next_index;
+             itr = pending.erase(itr)) {
+            std::cout << itr->first << ' ' << TypeName(itr->second) << '\n';
+            if (itr->second == kInvalidRecord) {
+                ++num_invalid;
+            } else if (itr->second == kUnknownRecord) {
+                ++num_unknown;
+            } else {
+                ++counts[itr->second];
+            }
+            ++next_index;
+        }
+        if (next_index > first_index) {
+            window.Release(next_index - first_index);
+        }
+    }
+    std::cout.flush();
+
+    std::cerr << "Classified " << next_index << " multitrees." << std::endl;
+    std::cerr << "    Satisfying (S): "
+              << counts[static_cast<int>(TypeOfMultitree::kS)] << std::endl;
+    std::cerr << "    Satisfying (CP) not (S): "
+              << counts[static_cast<int>(TypeOfMultitree::kCPNotS)]
+              << std::endl;
+    std::cerr << "    Satisfying (CV) not (CP): "
+              << counts[static_cast<int>(TypeOfMultitree::kCVNotCP)]
+              << std::endl;
+    std::cerr << "    Others: "
+              << counts[static_cast<int>(TypeOfMultitree::kNotTractable)]
+              << std::endl;
+    std::cerr << "    Invalid: " << num_invalid << std::endl;
+    std::cerr << "    Unknown (timed out): " << num_unknown << std::endl;
+}
+
+void Classify(const Options& options) {
+    FTMR::BoundedQueue<Job> jobs(options.queue_capacity);
+    FTMR::BoundedQueue<Result> results(options.queue_capacity);
+    RecordWindow window(options.queue_capacity);
+
+    std::thread parser(ParseStage, std::cref(options.files), std::ref(jobs),
+                       std::ref(window), options.num_workers);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < options.num_workers; ++i) {
+        workers.push_back(
+            std::thread(ClassifyStage, std::ref(jobs), std::ref(results),
+                        options.timeout));
+    }
+
+    OutputStage(results, window, options.num_workers);
+
+    parser.join();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+}  // namespace FTMRClassify
+
+int main(int argc, char* argv[]) {
+    FTMRClassify::Options options;
+    options.num_workers = std::thread::hardware_concurrency();
+    options.queue_capacity = 4096;
+    options.timeout = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if ((argument == "-j" || argument == "-q" || argument == "-t") &&
+            i + 1 < argc) {
+            int value = std::stoi(argv[++i]);
+            if (value <= 0) {
+                std::cout << "Invalid arguments." << std::endl;
+                return 0;
+            }
+            if (argument == "-j") {
+                options.num_workers = value;
+            } else if (argument == "-t") {
+                options.timeout = value;
+            } else {
+                options.queue_capacity = value;
+            }
+        } else if (argument[0] == '-' && argument != "-") {
+            std::cout << "Invalid arguments." << std::endl;
+            return 0;
+        } else {
+            options.files.push_back(argument);
+        }
+    }
+
+    if (options.num_workers <= 0) {
+        options.num_workers = 1;
+    }
+    FTMRClassify::Classify(options);
+}
@@ -0,0 +1,488 @@
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bounded_queue.hpp"
+#include "directed_graph.hpp"
+#include "multitree_classification.hpp"
+
+/* Protocol, all integers are uint32 in host byte order:
+ *
+ *   request:  num_vertices num_edges (from to) * num_edges
+ *   response: one byte, a TypeOfMultitree value, kInvalidResponse, or
+ *             kUnknownResponse if the request ran out of time
+ *
+ * A request with num_vertices = 0 and num_edges = 0 asks for the latency
+ * counters, answered with three uint64: number of requests, p50 and p99
+ * latency in nanoseconds. Requests that arrive in the same read are
+ * classified as one batch and answered with a single write. */
+namespace FTMRDaemon {
+constexpr uint8_t kUnknownResponse = 254;
+constexpr uint8_t kInvalidResponse = 255;
+constexpr uint32_t kMaxVertices = 1 << 20;
+constexpr uint32_t kMaxEdges = 1 << 22;
+constexpr size_t kNumCacheShards = 16;
+constexpr size_t kCacheShardCapacity = 1 << 14;
+
+std::atomic<bool> stop_requested(false);
+
+void HandleStopSignal(int) { stop_requested.store(true); }
+
+using Clock = std::chrono::steady_clock;
+
+/* Latency histogram with 8 buckets per power of two, updated without
+ * locks. Percentiles are reported as bucket upper bounds. */
+class LatencyHistogram {
+   public:
+    LatencyHistogram() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Record(uint64_t nanoseconds) {
+        buckets_[BucketIndex(nanoseconds)].fetch_add(
+            1, std::memory_order_relaxed);
+    }
+
+    uint64_t Count() const {
+        uint64_t count = 0;
+        for (auto& bucket : buckets_) {
+            count += bucket.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    uint64_t Percentile(double percentile) const {
+        uint64_t count = Count();
+        if (count == 0) {
+            return 0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * count);
+        if (rank >= count) {
+            rank = count - 1;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < kNumBuckets; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen > rank) {
+                return BucketUpperBound(i);
+            }
+        }
+        return BucketUpperBound(kNumBuckets - 1);
+    }
+
+   private:
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kNumBuckets = 64 * kSubBuckets;
+
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets_;
+
+    static int BucketIndex(uint64_t value) {
+        if (value < kSubBuckets) {
+            return value;
+        }
+        int exponent = 63;
+        while (!(value >> exponent)) {
+            --exponent;
+        }
+        // The three bits below the leading one select the sub-bucket.
+        int sub_bucket = (value >> (exponent - 3)) & (kSubBuckets - 1);
+        return (exponent - 2) * kSubBuckets + sub_bucket;
+    }
+
+    static uint64_t BucketUpperBound(int index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        int exponent = index / kSubBuckets + 2;
+        uint64_t sub_bucket = index % kSubBuckets;
+        return ((kSubBuckets + sub_bucket + 1) << (exponent - 3)) - 1;
+    }
+};
+
+/* Results keyed by the raw request bytes. Each shard is cleared when it
+ * fills up, which keeps the hot entries cheap to rebuild. */
+class ResultCache {
+   public:
+    bool Find(const std::string& key, uint8_t& response) {
+        Shard& shard = shards_[std::hash<std::string>()(key) % kNumCacheShards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto itr = shard.results.find(key);
+        if (itr == shard.results.end()) {
+            return false;
+        }
+        response = itr->second;
+        return true;
+    }
+
+    void Insert(const std::string& key, uint8_t response) {
+        Shard& shard = shards_[std::hash<std::string>()(key) % kNumCacheShards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.results.size() >= kCacheShardCapacity) {
+            shard.results.clear();
+        }
+        shard.results[key] = response;
+    }
+
+   private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, uint8_t> results;
+    };
+
+    std::array<Shard, kNumCacheShards> shards_;
+};
+
+// Requests of one read, answered together.
+struct Batch {
+    std::mutex mutex;
+    std::condition_variable done;
+    int remaining;
+};
+
+struct Task {
+    const char* request;
+    size_t request_size;
+    uint8_t* response;
+    Clock::time_point received;
+    Batch* batch;
+};
+
+uint32_t ReadUInt32(const char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/* Fixed pool of classification workers. Each worker keeps its own edges
+ * buffer, so decoding a request does not allocate once it is warm; the
+ * classification itself still allocates per request. Every request gets
+ * the same time limit, so one large request cannot hold a worker for long.
+ * Idle workers sleep in the task queue until a task or a null stop task
+ * arrives; the destructor sends one stop task per worker and joins them. */
+class ClassificationPool {
+   public:
+    ClassificationPool(int num_workers, size_t queue_capacity,
+                       std::chrono::milliseconds timeout)
+        : tasks_(queue_capacity), timeout_(timeout) {
+        for (int i = 0; i < num_workers; ++i) {
+            workers_.push_back(std::thread(&ClassificationPool::Work, this));
+        }
+    }
+
+    ~ClassificationPool() {
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            tasks_.Push(nullptr);
+        }
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ClassificationPool(const ClassificationPool&) = delete;
+
+    ClassificationPool& operator=(const ClassificationPool&) = delete;
+
+    void Submit(Task* task) { tasks_.Push(task); }
+
+    const LatencyHistogram& Latency() const { return latency_; }
+
+   private:
+    FTMR::BoundedQueue<Task*> tasks_;
+    std::chrono::milliseconds timeout_;
+    std::vector<std::thread> workers_;
+    ResultCache cache_;
+    LatencyHistogram latency_;
+
+    void Work() {
+        std::vector<std::pair<int, int>> edges;
+        std::string key;
+        Task* task;
+        while (true) {
+            tasks_.Pop(task);
+            if (task == nullptr) {
+                return;
+            }
+            key.assign(task->request, task->request_size);
+            uint8_t response;
+            if (!cache_.Find(key, response)) {
+                response = Classify(task->request, timeout_, edges);
+                if (response != kUnknownResponse) {
+                    cache_.Insert(key, response);
+                }
+            }
+            *task->response = response;
+
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - task->received);
+            latency_.Record(elapsed.count());
+
+            std::lock_guard<std::mutex> lock(task->batch->mutex);
+            if (--task->batch->remaining == 0) {
+                task->batch->done.notify_one();
+            }
+        }
+    }
+
+    static uint8_t Classify(const char* request,
+                            std::chrono::milliseconds timeout,
+                            std::vector<std::pair<int, int>>& edges) {
+        uint32_t num_vertices = ReadUInt32(request);
+        uint32_t num_edges = ReadUInt32(request + 4);
+        edges.resize(num_edges);
+        for (uint32_t i = 0; i < num_edges; ++i) {
+            edges[i].first = ReadUInt32(request + 8 + 8 * i);
+            edges[i].second = ReadUInt32(request + 12 + 8 * i);
+        }
+
+        try {
+            FTMR::Budget budget(timeout);
+            FTMR::DirectedGraph digraph(edges, num_vertices);
+            if (!digraph.IsMultitree(budget)) {
+                return kInvalidResponse;
+            }
+            FTMR::TypeOfMultitree type;
+            if (!FTMR::ClassifyMultitree(edges, num_vertices, budget, type)) {
+                return kUnknownResponse;
+            }
+            return static_cast<uint8_t>(type);
+        } catch (const FTMR::DeadlineExceeded&) {
+            return kUnknownResponse;
+        } catch (const std::exception&) {
+            return kInvalidResponse;
+        }
+    }
+};
+
+bool WriteAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+/* Reads requests from one client until it disconnects or the socket is shut
+ * down. The complete requests found in the buffer after a read are
+ * classified as one batch; a stats request ends the batch so that responses
+ * stay in request order. */
+void ServeConnection(int fd, ClassificationPool& pool) {
+    std::vector<char> buffer;
+    std::vector<Task> tasks;
+    std::vector<uint8_t> responses;
+    std::vector<char> output;
+    std::vector<char> chunk(1 << 16);
+
+    bool connection_open = true;
+    while (connection_open) {
+        ssize_t num_read = read(fd, chunk.data(), chunk.size());
+        if (num_read <= 0) {
+            break;
+        }
+        buffer.insert(buffer.end(), chunk.begin(), chunk.begin() + num_read);
+        Clock::time_point received = Clock::now();
+
+        size_t offset = 0;
+        while (connection_open) {
+            tasks.clear();
+            bool stats_requested = false;
+            while (buffer.size() - offset >= 8) {
+                uint32_t num_vertices = ReadUInt32(buffer.data() + offset);
+                uint32_t num_edges = ReadUInt32(buffer.data() + offset + 4);
+                if (num_vertices == 0 && num_edges == 0) {
+                    stats_requested = true;
+                    offset += 8;
+                    break;
+                }
+                if (num_vertices > kMaxVertices || num_edges > kMaxEdges) {
+                    connection_open = false;
+                    break;
+                }
+
+                size_t request_size = 8 + 8 * static_cast<size_t>(num_edges);
+                if (buffer.size() - offset < request_size) {
+                    break;
+                }
+                tasks.push_back(Task{buffer.data() + offset, request_size,
+                                     nullptr, received, nullptr});
+                offset += request_size;
+            }
+            if (!connection_open || (tasks.empty() && !stats_requested)) {
+                break;
+            }
+
+            output.clear();
+            if (!tasks.empty()) {
+                Batch batch;
+                batch.remaining = tasks.size();
+                responses.assign(tasks.size(), kInvalidResponse);
+                for (size_t i = 0; i < tasks.size(); ++i) {
+                    tasks[i].response = &responses[i];
+                    tasks[i].batch = &batch;
+                    pool.Submit(&tasks[i]);
+                }
+
+                std::unique_lock<std::mutex> lock(batch.mutex);
+                batch.done.wait(lock,
+                                [&batch]() { return batch.remaining == 0; });
+                output.insert(output.end(), responses.begin(),
+                              responses.end());
+            }
+
+            if (stats_requested) {
+                const LatencyHistogram& latency = pool.Latency();
+                uint64_t stats[3] = {latency.Count(), latency.Percentile(50),
+                                     latency.Percentile(99)};
+                const char* bytes = reinterpret_cast<const char*>(stats);
+                output.insert(output.end(), bytes, bytes + sizeof(stats));
+            }
+
+            connection_open = WriteAll(fd, output.data(), output.size());
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + offset);
+    }
+}
+
+// A client connection. The accept loop closes fd only after joining thread,
+// so the fd cannot be reused while it may still be shut down.
+struct Connection {
+    int fd;
+    std::atomic<bool> finished;
+    std::thread thread;
+};
+
+/* Joins the connections whose clients have disconnected. With stop set, it
+ * first shuts down every socket so that blocked reads return, and joins all
+ * of them. */
+void ReapConnections(std::list<Connection>& connections, bool stop) {
+    for (auto itr = connections.begin(); itr != connections.end();) {
+        if (stop) {
+            shutdown(itr->fd, SHUT_RDWR);
+        } else if (!itr->finished.load()) {
+            ++itr;
+            continue;
+        }
+        itr->thread.join();
+        close(itr->fd);
+        itr = connections.erase(itr);
+    }
+}
+
+void RunDaemon(const std::string& socket_path, int num_workers,
+               std::chrono::milliseconds timeout) {
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (listen_fd < 0 || socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Cannot create socket." << std::endl;
+        return;
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+    unlink(socket_path.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) < 0 ||
+        listen(listen_fd, SOMAXCONN) < 0) {
+        std::cerr << "Cannot listen on " << socket_path << "." << std::endl;
+        close(listen_fd);
+        return;
+    }
+
+    // Declared before the connections, which use it, so that it is still
+    // alive when they are joined.
+    ClassificationPool pool(num_workers, 4096, timeout);
+    std::list<Connection> connections;
+    std::cerr << "Listening on " << socket_path << " with " << num_workers
+              << " workers." << std::endl;
+
+    while (!stop_requested.load()) {
+        ReapConnections(connections, false);
+        pollfd poll_fd = {listen_fd, POLLIN, 0};
+        if (poll(&poll_fd, 1, 200) <= 0) {
+            continue;
+        }
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        connections.emplace_back();
+        Connection& connection = connections.back();
+        connection.fd = fd;
+        connection.finished.store(false);
+        connection.thread = std::thread([&connection, &pool]() {
+            ServeConnection(connection.fd, pool);
+            connection.finished.store(true);
+        });
+    }
+
+    close(listen_fd);
+    ReapConnections(connections, true);
+    unlink(socket_path.c_str());
+
+    const LatencyHistogram& latency = pool.Latency();
+    std::cerr << "Served " << latency.Count() << " requests." << std::endl;
+    std::cerr << "    p50 latency: " << latency.Percentile(50) << " ns"
+              << std::endl;
+    std::cerr << "    p99 latency: " << latency.Percentile(99) << " ns"
+              << std::endl;
+}
+}  // namespace FTMRDaemon
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argv[1][0] == '-') {
+        std::cout << "Invalid arguments." << std::endl;
+        return 0;
+    }
+
+    int num_workers = std::thread::hardware_concurrency();
+    int timeout = 1000;
+    for (int i = 2; i < argc; ++i) {
+        std::string argument = argv[i];
+        if ((argument != "-j" && argument != "-t") || i + 1 == argc) {
+            std::cout << "Invalid arguments." << std::endl;
+            return 0;
+        }
+        int value = std::stoi(argv[++i]);
+        if (value <= 0) {
+            std::cout << "Invalid arguments." << std::endl;
+            return 0;
+        }
+        if (argument == "-j") {
+            num_workers = value;
+        } else {
+            timeout = value;
+        }
+    }
+    if (num_workers <= 0) {
+        num_workers = 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, FTMRDaemon::HandleStopSignal);
+    signal(SIGTERM, FTMRDaemon::HandleStopSignal);
+    FTMRDaemon::RunDaemon(argv[1], num_workers,
+                          std::chrono::milliseconds(timeout));
+}
@@ -0,0 +1,45 @@
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "edge_list_reader.hpp"
+#include "tree_catalog.hpp"
+
+/* Converts a text trees data file into a binary tree catalog. */
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cout << "Invalid arguments." << std::endl;
+        return 0;
+    }
+
+    std::ifstream file(argv[1]);
+    if (!file) {
+        std::cerr << "Trees file not found." << std::endl;
+        return 1;
+    }
+
+    FTMR::EdgeListReader reader(file);
+    FTMR::EdgeListRecord record;
+    std::vector<uint64_t> codes;
+    int num_vertices = 0;
+    while (reader.Next(record)) {
+        if (codes.empty()) {
+            num_vertices = record.num_vertices;
+        } else if (record.num_vertices != num_vertices) {
+            throw std::runtime_error(
+                "All trees must have the same number of vertices.");
+        }
+        codes.push_back(FTMR::EncodeTree(record.edges, record.num_vertices));
+    }
+
+    if (codes.empty()) {
+        std::cerr << "No trees found." << std::endl;
+        return 1;
+    }
+
+    FTMR::WriteTreeCatalog(argv[2], num_vertices, codes);
+    std::cout << "Wrote " << codes.size() << " trees with " << num_vertices
+              << " vertices." << std::endl;
+}
@@ -0,0 +1,114 @@
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "multitree_classification.hpp"
+#include "multitree_generator.hpp"
+#include "progress_reporter.hpp"
+
+namespace FTMRSearch {
+using FTMR::TypeOfMultitree;
+
+struct Options {
+    int num_vertices;
+    int num_threads;
+    // Seconds between progress lines on stderr, or 0 for none.
+    int progress_interval;
+    // JSON status file rewritten with every sample, or empty for none.
+    std::string status_file;
+};
+
+void SearchAllMultitrees(const Options& options) {
+    int num_vertices = options.num_vertices;
+    int num_threads = options.num_threads;
+    std::cout << "Searching all multitrees with " << num_vertices
+              << " vertices using " << num_threads << " threads."
+              << std::endl;
+    std::cout << "Running..." << std::endl;
+
+    // Counters per thread, indexed by TypeOfMultitree.
+    std::vector<std::array<long long, 4>> counts(num_threads,
+                                                 std::array<long long, 4>{});
+
+    // The number of multitrees is not known in advance, so there is no ETA.
+    int interval = options.progress_interval > 0 ? options.progress_interval
+                                                 : 10;
+    FTMR::ProgressReporter progress(
+        "multitrees", {"S", "CP", "CV", "Others"}, num_threads, 0,
+        std::chrono::seconds(interval), options.progress_interval > 0,
+        options.status_file);
+    if (options.progress_interval > 0 || !options.status_file.empty()) {
+        progress.Start();
+    }
+
+    FTMR::MultitreeGenerator generator(num_vertices, num_threads);
+    long long num_multitrees = generator.Generate(
+        [&](const std::vector<std::pair<int, int>>& edges, int thread_index) {
+            TypeOfMultitree type = FTMR::ClassifyMultitree(edges, num_vertices);
+            ++counts[thread_index][static_cast<int>(type)];
+            progress.Add(thread_index, static_cast<int>(type));
+        });
+    progress.Stop();
+
+    std::array<long long, 4> total = {};
+    for (auto& thread_counts : counts) {
+        for (int i = 0; i < 4; ++i) {
+            total[i] += thread_counts[i];
+        }
+    }
+
+    std::cout << "======================================" << std::endl;
+    std::cout << "Result: " << std::endl;
+    std::cout << "Search " << num_multitrees << " multitrees." << std::endl;
+    std::cout << "    Satisfying (S): "
+              << total[static_cast<int>(TypeOfMultitree::kS)] << std::endl;
+    std::cout << "    Satisfying (CP) not (S): "
+              << total[static_cast<int>(TypeOfMultitree::kCPNotS)]
+              << std::endl;
+    std::cout << "    Satisfying (CV) not (CP): "
+              << total[static_cast<int>(TypeOfMultitree::kCVNotCP)]
+              << std::endl;
+    std::cout << "    Others: "
+              << total[static_cast<int>(TypeOfMultitree::kNotTractable)]
+              << std::endl;
+}
+}  // namespace FTMRSearch
+
+int main(int argc, char* argv[]) {
+    FTMRSearch::Options options;
+    options.num_vertices = 0;
+    options.num_threads = std::thread::hardware_concurrency();
+    options.progress_interval = 0;
+
+    int num_positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "-p" && i + 1 < argc) {
+            options.progress_interval = std::stoi(argv[++i]);
+        } else if (argument == "-s" && i + 1 < argc) {
+            options.status_file = argv[++i];
+        } else if (argument[0] != '-' && num_positional == 0) {
+            options.num_vertices = std::stoi(argument);
+            ++num_positional;
+        } else if (argument[0] != '-' && num_positional == 1) {
+            options.num_threads = std::stoi(argument);
+            ++num_positional;
+        } else {
+            num_positional = 0;
+            break;
+        }
+    }
+
+    if (num_positional == 0 || options.progress_interval < 0) {
+        std::cout << "Invalid arguments." << std::endl;
+        return 0;
+    }
+    if (options.num_threads <= 0) {
+        options.num_threads = 1;
+    }
+    FTMRSearch::SearchAllMultitrees(options);
+}
@@ -1,12 +1,20 @@
+#include <chrono>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <sstream>
+#include <limits>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include "multitree_recolorability.hpp"
+#include "edge_list_reader.hpp"
+#include "multitree_classification.hpp"
+#include "polytree_orientations.hpp"
+#include "progress_reporter.hpp"
+#include "tree_catalog.hpp"
 
 namespace FTMRSearch {
 using EdgesList = std::vector<std::pair<int, int>>;
@@ -14,85 +22,142 @@ using EdgesList = std::vector<std::pair<int, int>>;
 constexpr char kTreesDataDir[] = "example/trees/";
 constexpr char kTreesFileName[] = "trees_data";
 
-enum class TypeOfPolytree {
-    kS,
-    kCPNotS,
-    kCVNotCP,
-    kNotTractable,
+using FTMR::TypeOfMultitree;
+
+struct Options {
+    int num_vertices;
+    // Seconds between progress lines on stderr, or 0 for none.
+    int progress_interval;
+    // JSON status file rewritten with every sample, or empty for none.
+    std::string status_file;
+    // Count the orientations satisfying (S) without classifying the rest.
+    bool count_only;
 };
 
-TypeOfPolytree ClassifyMultitree(const std::vector<std::pair<int, int>>& edges,
-                                 int num_vertices) {
-    FTMR::MultitreeRecolorability multitree(edges, num_vertices);
-    if (multitree.CheckConditionS()) {
-        return TypeOfPolytree::kS;
-    } else if (multitree.CheckConditionCP()) {
-        return TypeOfPolytree::kCPNotS;
-    } else if (multitree.CheckConditionCV()) {
-        return TypeOfPolytree::kCVNotCP;
-    } else {
-        return TypeOfPolytree::kNotTractable;
+using TreeVisitor = std::function<void(const EdgesList& edges)>;
+
+void VisitTreesInCatalog(const std::string& filename, int num_vertices,
+                         const TreeVisitor& visitor) {
+    FTMR::TreeCatalogReader reader(filename);
+    if (reader.NumVertices() != num_vertices) {
+        throw std::runtime_error("Invalid trees data.");
+    }
+
+    EdgesList edges(num_vertices - 1);
+    while (reader.Next(edges)) {
+        visitor(edges);
     }
 }
 
-std::vector<EdgesList> GetTrees(int num_vertices) {
-    std::vector<EdgesList> trees_list;
+/* Streams the binary tree catalog if it exists, and the text trees data
+ * otherwise. Returns false if neither exists. */
+bool VisitTrees(int num_vertices, const TreeVisitor& visitor) {
     std::string filename = std::string(kTreesDataDir) +
                            std::string(kTreesFileName) + "_" +
-                           std::to_string(num_vertices) + ".txt";
+                           std::to_string(num_vertices);
 
-    std::ifstream file(filename);
+    if (std::ifstream(filename + ".bin")) {
+        VisitTreesInCatalog(filename + ".bin", num_vertices, visitor);
+        return true;
+    }
+
+    std::ifstream file(filename + ".txt");
     if (!file) {
         std::cerr << "Trees file not found." << std::endl;
-        return trees_list;
+        return false;
     }
-    std::string line;
-
-    while (std::getline(file, line)) {
-        if (line.substr(0, 5) != "Graph") {
-            continue;
-        }
 
-        std::getline(file, line);
-        std::string number;
-        std::stringstream ss(line);
-        ss >> number;
-        int input_vertices = std::stoi(number);
-        ss >> number;
-        int input_edges = std::stoi(number);
-        if (input_vertices != num_vertices || input_edges != num_vertices - 1) {
+    FTMR::EdgeListReader reader(file);
+    FTMR::EdgeListRecord record;
+    while (reader.Next(record)) {
+        if (record.num_vertices != num_vertices ||
+            record.edges.size() != num_vertices - 1) {
             throw std::runtime_error("Invalid trees data.");
         }
+        visitor(record.edges);
+    }
+    return true;
+}
 
-        EdgesList edges(num_vertices - 1);
-        std::getline(file, line);
-        ss = std::stringstream(line);
-        for (int i = 0; i < num_vertices - 1; ++i) {
-            ss >> number;
-            int start_vertex = std::stoi(number);
-            ss >> number;
-            int end_vertex = std::stoi(number);
-            edges[i] = {start_vertex, end_vertex};
-        }
-
+std::vector<EdgesList> GetTrees(int num_vertices) {
+    std::vector<EdgesList> trees_list;
+    VisitTrees(num_vertices, [&trees_list](const EdgesList& edges) {
         trees_list.push_back(edges);
-    }
+    });
     return trees_list;
 }
 
-EdgesList FlipEdges(const EdgesList& original, int flip_bits) {
-    EdgesList result(original.size());
-    for (int i = 0; i < original.size(); ++i) {
-        if (flip_bits & (1 << i)) {
-            result[i] = {original[i].second, original[i].first};
-        } else {
-            result[i] = original[i];
+/* The status file is sampled every 10 seconds when stderr is quiet. */
+std::unique_ptr<FTMR::ProgressReporter> StartProgress(
+    const Options& options, const std::vector<std::string>& class_names,
+    uint64_t total) {
+    int interval = options.progress_interval > 0 ? options.progress_interval
+                                                 : 10;
+    std::unique_ptr<FTMR::ProgressReporter> progress(
+        new FTMR::ProgressReporter("polytrees", class_names, 1, total,
+                                   std::chrono::seconds(interval),
+                                   options.progress_interval > 0,
+                                   options.status_file));
+    if (options.progress_interval > 0 || !options.status_file.empty()) {
+        progress->Start();
+    }
+    return progress;
+}
+
+/* Counts the orientations satisfying (S) by dynamic programming, one tree at
+ * a time as the trees are read, so the number of vertices is limited only by
+ * the trees data and 64 bit counts. */
+void CountAllPolytrees(const Options& options) {
+    int num_vertices = options.num_vertices;
+    std::cout << "Counting all polytrees with " << num_vertices
+              << " vertices." << std::endl;
+    std::cout << "Running..." << std::endl;
+
+    // The number of trees is not known before reading them all.
+    std::unique_ptr<FTMR::ProgressReporter> progress =
+        StartProgress(options, {"S", "Not S"}, 0);
+
+    // The count per tree is exact, but the totals exceed 64 bits from about
+    // n = 31. num_s never exceeds num_polytrees, so checking it is enough.
+    uint64_t num_polytrees = 0;
+    uint64_t num_s = 0;
+    bool is_overflowed = false;
+    bool is_found = VisitTrees(num_vertices, [&](const EdgesList& edges) {
+        if (is_overflowed) {
+            return;
         }
+        FTMR::TreeOrientations orientations(edges, num_vertices);
+        if (orientations.NumOrientations() >
+            std::numeric_limits<uint64_t>::max() - num_polytrees) {
+            is_overflowed = true;
+            return;
+        }
+        uint64_t num_tree_s = orientations.CountConditionS();
+        num_polytrees += orientations.NumOrientations();
+        num_s += num_tree_s;
+        progress->Add(0, 0, num_tree_s);
+        progress->Add(0, 1, orientations.NumOrientations() - num_tree_s);
+    });
+    progress->Stop();
+    if (!is_found) {
+        return;
+    }
+    if (is_overflowed) {
+        std::cerr << "The number of polytrees does not fit in 64 bits."
+                  << std::endl;
+        return;
     }
-    return result;
+
+    std::cout << "======================================" << std::endl;
+    std::cout << "Result: " << std::endl;
+    std::cout << "Count " << num_polytrees << " polytrees." << std::endl;
+    std::cout << "    Satisfying (S): " << num_s << std::endl;
+    std::cout << "    Not satisfying (S): " << num_polytrees - num_s
+              << std::endl;
 }
 
-void SearchAllPolytrees(int num_vertices) {
+void SearchAllPolytrees(const Options& options) {
+    int num_vertices = options.num_vertices;
     std::cout << "Searching all polytrees with " << num_vertices << " vertices."
               << std::endl;
     std::cout << "Running..." << std::endl;
@@ -103,38 +168,67 @@ void SearchAllPolytrees(int num_vertices) {
         return;
     }
 
-    int num_s = 0;
-    int num_cp_not_s = 0;
-    int num_cv = 0;
-    int num_not_tractable = 0;
+    uint64_t num_polytrees =
+        trees_list.size() * (uint64_t(1) << (num_vertices - 1));
+    std::unique_ptr<FTMR::ProgressReporter> progress =
+        StartProgress(options, {"S", "CP", "CV", "Others"}, num_polytrees);
+
+    long long num_s = 0;
+    long long num_cp_not_s = 0;
+    long long num_cv = 0;
+    long long num_not_tractable = 0;
     for (auto& edges_list : trees_list) {
+        // Trees whose orientations all satisfy (S) are counted at once.
+        // Otherwise (S) is evaluated for 256 orientations at a time, and
+        // only the orientations failing it are classified one by one.
+        FTMR::TreeOrientations orientations(edges_list, num_vertices);
+        uint64_t num_tree_s = orientations.CountConditionS();
+        if (num_tree_s == orientations.NumOrientations()) {
+            num_s += num_tree_s;
+            progress->Add(0, static_cast<int>(TypeOfMultitree::kS),
+                          num_tree_s);
+            continue;
+        }
+
+        // The orientations failing (S) share the skeleton of the tree.
+        FTMR::PolytreeSkeleton skeleton(edges_list, num_vertices);
+        uint64_t condition_s_masks[4];
         for (int flip_bits = 0; flip_bits < (1 << (num_vertices - 1));
              ++flip_bits) {
-            EdgesList new_edges_list = FlipEdges(edges_list, flip_bits);
-            TypeOfPolytree type =
-                ClassifyMultitree(new_edges_list, num_vertices);
+            if (flip_bits % 256 == 0) {
+                orientations.ConditionSMasks(flip_bits, condition_s_masks);
+            }
+            if ((condition_s_masks[flip_bits % 256 / 64] >> (flip_bits % 64)) &
+                1) {
+                ++num_s;
+                progress->Add(0, static_cast<int>(TypeOfMultitree::kS));
+                continue;
+            }
+
+            TypeOfMultitree type = FTMR::ClassifyMultitree(skeleton, flip_bits);
+            progress->Add(0, static_cast<int>(type));
 
             switch (type) {
-                case TypeOfPolytree::kS:
+                case TypeOfMultitree::kS:
                     ++num_s;
                     break;
-                case TypeOfPolytree::kCPNotS:
+                case TypeOfMultitree::kCPNotS:
                     ++num_cp_not_s;
                     break;
-                case TypeOfPolytree::kCVNotCP:
+                case TypeOfMultitree::kCVNotCP:
                     ++num_cv;
                     break;
-                case TypeOfPolytree::kNotTractable:
+                case TypeOfMultitree::kNotTractable:
                     ++num_not_tractable;
                     break;
             }
         }
     }
+    progress->Stop();
 
     std::cout << "======================================" << std::endl;
     std::cout << "Result: " << std::endl;
-    std::cout << "Search " << (trees_list.size() * (1 << (num_vertices - 1)))
-              << " polytrees." << std::endl;
+    std::cout << "Search " << num_polytrees << " polytrees." << std::endl;
     std::cout << "    Satisfying (S): " << num_s << std::endl;
     std::cout << "    Satisfying (CP) not (S): " << num_cp_not_s << std::endl;
     std::cout << "    Satisfying (CV) not (CP): " << num_cv << std::endl;
@@ -143,11 +237,34 @@ void SearchAllPolytrees(int num_vertices) {
 }  // namespace FTMRSearch
 
 int main(int argc, char* argv[]) {
-    if (argc == 1 || argc > 2) {
+    FTMRSearch::Options options;
+    options.num_vertices = 0;
+    options.progress_interval = 0;
+    options.count_only = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "-p" && i + 1 < argc) {
+            options.progress_interval = std::stoi(argv[++i]);
+        } else if (argument == "-s" && i + 1 < argc) {
+            options.status_file = argv[++i];
+        } else if (argument == "-c") {
+            options.count_only = true;
+        } else if (argument[0] != '-' && options.num_vertices == 0) {
+            options.num_vertices = std::stoi(argument);
+        } else {
+            options.num_vertices = 0;
+            break;
+        }
+    }
+
+    if (options.num_vertices <= 0 || options.progress_interval < 0) {
         std::cout << "Invalid arguments." << std::endl;
         return 0;
     }
-
-    int num_vertices = std::stoi(argv[1]);
-    FTMRSearch::SearchAllPolytrees(num_vertices);
-}
\ No newline at end of file
+    if (options.count_only) {
+        FTMRSearch::CountAllPolytrees(options);
+    } else {
+        FTMRSearch::SearchAllPolytrees(options);
+    }
+}
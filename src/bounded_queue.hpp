@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace FTMR {
+
+// Bounded lock-free multi-producer multi-consumer queue (Vyukov). Every cell
+// carries a sequence number telling producers and consumers whose turn it
+// is, so TryPush and TryPop only contend on one atomic position each. Push
+// and Pop sleep on a condition variable while the queue is full or empty,
+// and the mutex is only taken when some thread is sleeping.
+template <typename T>
+class BoundedQueue {
+   public:
+    // The capacity is rounded up to a power of two, and to at least 2 since
+    // with a single cell a full queue has the sequence of an empty one.
+    explicit BoundedQueue(size_t capacity)
+        : enqueue_position_(0),
+          dequeue_position_(0),
+          num_waiting_producers_(0),
+          num_waiting_consumers_(0) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Capacity must be greater than 0.");
+        }
+
+        size_t rounded_capacity = 2;
+        while (rounded_capacity < capacity) {
+            rounded_capacity <<= 1;
+        }
+
+        cells_.reset(new Cell[rounded_capacity]);
+        mask_ = rounded_capacity - 1;
+        for (size_t i = 0; i < rounded_capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~BoundedQueue() = default;
+
+    BoundedQueue(const BoundedQueue&) = delete;
+
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    size_t Capacity() const { return mask_ + 1; }
+
+    // Returns false when the queue is full. value is only moved from on
+    // success.
+    bool TryPush(T& value) {
+        if (!TryPushWithoutWakeUp(value)) {
+            return false;
+        }
+        WakeUp(num_waiting_consumers_, not_empty_);
+        return true;
+    }
+
+    // Returns false when the queue is empty.
+    bool TryPop(T& value) {
+        if (!TryPopWithoutWakeUp(value)) {
+            return false;
+        }
+        WakeUp(num_waiting_producers_, not_full_);
+        return true;
+    }
+
+    // Blocking versions, sleeping while the queue is full or empty.
+    void Push(T value) {
+        if (TryPush(value)) {
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            num_waiting_producers_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            not_full_.wait(lock,
+                           [&]() { return TryPushWithoutWakeUp(value); });
+            num_waiting_producers_.fetch_sub(1);
+        }
+        WakeUp(num_waiting_consumers_, not_empty_);
+    }
+
+    void Pop(T& value) {
+        if (TryPop(value)) {
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            num_waiting_consumers_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            not_empty_.wait(lock,
+                            [&]() { return TryPopWithoutWakeUp(value); });
+            num_waiting_consumers_.fetch_sub(1);
+        }
+        WakeUp(num_waiting_producers_, not_full_);
+    }
+
+   private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_position_;
+    alignas(64) std::atomic<size_t> dequeue_position_;
+
+    alignas(64) std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::atomic<int> num_waiting_producers_;
+    std::atomic<int> num_waiting_consumers_;
+
+    // A sleeper registers itself and then tries once more under the mutex.
+    // With a fence on both sides, either that try sees the completed
+    // operation or this check sees the sleeper and wakes it up.
+    void WakeUp(std::atomic<int>& num_waiting,
+                std::condition_variable& condition) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (num_waiting.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            condition.notify_all();
+        }
+    }
+
+    bool TryPushWithoutWakeUp(T& value) {
+        size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[position & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) -
+                                        static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (enqueue_position_.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPopWithoutWakeUp(T& value) {
+        size_t position = dequeue_position_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[position & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference =
+                static_cast<std::ptrdiff_t>(sequence) -
+                static_cast<std::ptrdiff_t>(position + 1);
+            if (difference == 0) {
+                if (dequeue_position_.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->value);
+        cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+}  // namespace FTMR
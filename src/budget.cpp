@@ -0,0 +1,35 @@
+#include "budget.hpp"
+
+namespace FTMR {
+Budget::Budget()
+    : has_deadline_(false), deadline_(), is_cancelled_(false), num_calls_(0) {}
+
+Budget::Budget(std::chrono::steady_clock::duration timeout)
+    : has_deadline_(true),
+      deadline_(std::chrono::steady_clock::now() + timeout),
+      is_cancelled_(false),
+      num_calls_(0) {}
+
+bool Budget::Expired() {
+    if (IsCancelled()) {
+        return true;
+    }
+    if (!has_deadline_ ||
+        num_calls_.fetch_add(1, std::memory_order_relaxed) % kClockInterval !=
+            0) {
+        return false;
+    }
+
+    if (std::chrono::steady_clock::now() >= deadline_) {
+        Cancel();
+        return true;
+    }
+    return false;
+}
+
+void CheckBudget(Budget* budget) {
+    if (budget != nullptr && budget->Expired()) {
+        throw DeadlineExceeded();
+    }
+}
+}  // namespace FTMR
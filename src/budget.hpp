@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+namespace FTMR {
+
+// Result of a condition check that may run out of budget.
+enum class CheckResult {
+    kNotSatisfied,
+    kSatisfied,
+    kUnknown,
+};
+
+// Thrown by the long-running algorithms when their budget runs out.
+class DeadlineExceeded : public std::runtime_error {
+   public:
+    DeadlineExceeded() : std::runtime_error("Deadline exceeded.") {}
+};
+
+// Cooperative limit on a computation: an optional deadline and a cancel
+// flag. The algorithms taking a Budget call Expired() at safe points, so a
+// Budget can be shared by the threads of one computation and cancelled from
+// any other thread.
+class Budget {
+   public:
+    // No deadline, only cancellation.
+    Budget();
+
+    explicit Budget(std::chrono::steady_clock::duration timeout);
+
+    ~Budget() = default;
+
+    Budget(const Budget&) = delete;
+
+    Budget& operator=(const Budget&) = delete;
+
+    void Cancel() { is_cancelled_.store(true, std::memory_order_relaxed); }
+
+    bool IsCancelled() const {
+        return is_cancelled_.load(std::memory_order_relaxed);
+    }
+
+    // Returns true once Cancel() was called or the deadline has passed. The
+    // clock is only read on every kClockInterval-th call.
+    bool Expired();
+
+   private:
+    static constexpr unsigned int kClockInterval = 256;
+
+    bool has_deadline_;
+    std::chrono::steady_clock::time_point deadline_;
+    std::atomic<bool> is_cancelled_;
+    std::atomic<unsigned int> num_calls_;
+};
+
+// Throws DeadlineExceeded if budget is not null and has expired.
+void CheckBudget(Budget* budget);
+
+}  // namespace FTMR
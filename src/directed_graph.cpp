@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <deque>
 #include <stdexcept>
+#include <thread>
 
 namespace FTMR {
 DirectedGraph::DirectedGraph(const std::vector<std::pair<int, int>>& edges_list,
@@ -76,6 +77,10 @@ bool DirectedGraph::IsAdjacent(int vertex1, int vertex2) const {
 }
 
 bool DirectedGraph::IsDAG() const {
+    if (dynamic_order_valid_) {
+        return num_components_ == num_vertices_ && num_self_loops_ == 0;
+    }
+
     enum struct VertexState { NOT_VISITED, VISITING, VISITED };
     std::vector<VertexState> vertex_state(num_vertices_,
                                           VertexState::NOT_VISITED);
@@ -123,15 +128,61 @@ bool DirectedGraph::IsDAG() const {
     return true;
 }
 
+bool DirectedGraph::IsMultitree() const { return IsMultitree(nullptr); }
+
+bool DirectedGraph::IsMultitree(Budget& budget) const {
+    return IsMultitree(&budget);
+}
+
+/* In a DAG, an edge into a vertex already reached from start closes a
+ * second path from start, so the search from every vertex must reach each
+ * vertex once. Each search then stops within n steps. */
+bool DirectedGraph::IsMultitree(Budget* budget) const {
+    if (!IsDAG()) {
+        return false;
+    }
+
+    std::vector<int> reached_from(num_vertices_, -1);
+    std::vector<int> stack;
+    for (int start = 0; start < num_vertices_; ++start) {
+        reached_from[start] = start;
+        stack.assign(1, start);
+        while (!stack.empty()) {
+            CheckBudget(budget);
+            int vertex = stack.back();
+            stack.pop_back();
+            for (auto& adjacent_vertex : adjacency_list_[vertex]) {
+                if (reached_from[adjacent_vertex] == start) {
+                    return false;
+                }
+                reached_from[adjacent_vertex] = start;
+                stack.push_back(adjacent_vertex);
+            }
+        }
+    }
+    return true;
+}
+
 std::vector<std::vector<int>> DirectedGraph::UnilaterallyConnectedComponents()
     const {
+    return UnilaterallyConnectedComponents(nullptr);
+}
+
+std::vector<std::vector<int>> DirectedGraph::UnilaterallyConnectedComponents(
+    Budget& budget) const {
+    return UnilaterallyConnectedComponents(&budget);
+}
+
+std::vector<std::vector<int>> DirectedGraph::UnilaterallyConnectedComponents(
+    Budget* budget) const {
     std::vector<std::vector<int>> connected_components_list;
 
     for (int vertex = 0; vertex < num_vertices_; ++vertex) {
         if (reverse_adjacency_list_[vertex].size() == 0) {
             connected_components_list.push_back(std::vector<int>());
             int component_index = connected_components_list.size() - 1;
-            PathSearch(vertex, connected_components_list, component_index);
+            PathSearch(vertex, connected_components_list, component_index,
+                       budget);
         }
     }
 
@@ -143,6 +194,25 @@ std::vector<std::vector<int>> DirectedGraph::StronglyConnectedComponents()
     const {
     std::vector<std::vector<int>> connected_components_list;
 
+    if (dynamic_order_valid_) {
+        std::vector<int> representatives;
+        for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+            if (component_[vertex] == vertex) {
+                representatives.push_back(vertex);
+            }
+        }
+        std::sort(representatives.begin(), representatives.end(),
+                  [this](int component1, int component2) {
+                      return component_order_[component1] <
+                             component_order_[component2];
+                  });
+        for (auto& representative : representatives) {
+            connected_components_list.push_back(
+                component_members_[representative]);
+        }
+        return connected_components_list;
+    }
+
     std::vector<bool> visited_vertices(num_vertices_, false);
     std::deque<int> finished_vertices_stack;
 
@@ -170,34 +240,175 @@ std::vector<std::vector<int>> DirectedGraph::StronglyConnectedComponents()
 }
 
 std::vector<std::vector<int>> DirectedGraph::SimpleCycles() const {
-    std::unordered_set<int> blocked_set;
-    std::unordered_map<int, std::unordered_set<int>> blocked_map;
-    std::deque<int> stack;
-    std::vector<std::vector<int>> cycles;
+    return SimpleCycles(1, nullptr);
+}
 
-    std::vector<std::vector<int>> strongly_connected_components =
-        StronglyConnectedComponents();
+std::vector<std::vector<int>> DirectedGraph::SimpleCycles(
+    int num_threads) const {
+    return SimpleCycles(num_threads, nullptr);
+}
 
-    for (auto& component : strongly_connected_components) {
-        if (component.size() == 1) {
-            continue;
-        }
+std::vector<std::vector<int>> DirectedGraph::SimpleCycles(
+    int num_threads, Budget& budget) const {
+    return SimpleCycles(num_threads, &budget);
+}
+
+bool DirectedGraph::VisitSimpleCycles(const CycleVisitor& visitor,
+                                      int num_threads) const {
+    return VisitSimpleCycles(visitor, num_threads, nullptr);
+}
+
+bool DirectedGraph::VisitSimpleCycles(const CycleVisitor& visitor,
+                                      int num_threads, Budget& budget) const {
+    return VisitSimpleCycles(visitor, num_threads, &budget);
+}
 
-        std::sort(component.begin(), component.end());
-        for (int i = 0; i < component.size(); ++i) {
-            blocked_set.clear();
-            blocked_map.clear();
-            stack.clear();
-            DirectedGraph search_graph = CreateSubgraph(
-                std::vector<int>(component.begin() + i, component.end()));
-            FindCyclesInSCCJohnson(search_graph, blocked_set, blocked_map,
-                                   stack, cycles, component[i], component[i]);
+std::vector<std::vector<int>> DirectedGraph::SimpleCycles(
+    int num_threads, Budget* budget) const {
+    std::vector<std::vector<int>> components = StronglyConnectedComponents();
+    std::vector<std::pair<int, int>> tasks = CycleSearchTasks(components);
+
+    // Each task collects its own cycles, concatenated in task order.
+    std::vector<std::vector<std::vector<int>>> task_cycles(tasks.size());
+    std::atomic<bool> is_stopped(false);
+    std::atomic<int> next_task(0);
+    auto run_tasks = [&]() {
+        for (int task = next_task++;
+             task < tasks.size() && !is_stopped.load(std::memory_order_relaxed);
+             task = next_task++) {
+            std::vector<std::vector<int>>& cycles = task_cycles[task];
+            SearchCyclesFrom(components[tasks[task].first], tasks[task].second,
+                             [&cycles](const std::vector<int>& cycle) {
+                                 cycles.push_back(cycle);
+                                 return true;
+                             },
+                             is_stopped, budget);
         }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < num_threads && i < tasks.size(); ++i) {
+        threads.push_back(std::thread(run_tasks));
+    }
+    run_tasks();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (is_stopped.load()) {
+        throw DeadlineExceeded();
     }
 
+    std::vector<std::vector<int>> cycles;
+    for (auto& cycles_of_task : task_cycles) {
+        for (auto& cycle : cycles_of_task) {
+            cycles.push_back(std::move(cycle));
+        }
+    }
     return cycles;
 }
 
+bool DirectedGraph::VisitSimpleCycles(const CycleVisitor& visitor,
+                                      int num_threads, Budget* budget) const {
+    std::vector<std::vector<int>> components = StronglyConnectedComponents();
+    std::vector<std::pair<int, int>> tasks = CycleSearchTasks(components);
+
+    // The search also stops when the budget runs out, so remember whether
+    // the visitor decided it.
+    std::atomic<bool> is_stopped(false);
+    std::atomic<bool> is_stopped_by_visitor(false);
+    CycleVisitor stopping_visitor = [&](const std::vector<int>& cycle) {
+        if (visitor(cycle)) {
+            return true;
+        }
+        is_stopped_by_visitor.store(true);
+        return false;
+    };
+
+    std::atomic<int> next_task(0);
+    auto run_tasks = [&]() {
+        for (int task = next_task++;
+             task < tasks.size() && !is_stopped.load(std::memory_order_relaxed);
+             task = next_task++) {
+            SearchCyclesFrom(components[tasks[task].first], tasks[task].second,
+                             stopping_visitor, is_stopped, budget);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < num_threads && i < tasks.size(); ++i) {
+        threads.push_back(std::thread(run_tasks));
+    }
+    run_tasks();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (is_stopped_by_visitor.load()) {
+        return false;
+    }
+    if (is_stopped.load()) {
+        throw DeadlineExceeded();
+    }
+    return true;
+}
+
+std::vector<int> DirectedGraph::TopologicalOrder() const {
+    std::vector<int> order;
+    for (auto& component : StronglyConnectedComponents()) {
+        order.insert(order.end(), component.begin(), component.end());
+    }
+    return order;
+}
+
+void DirectedGraph::AddEdge(int from, int to) {
+    if (InvalidVertexNumber(from) || InvalidVertexNumber(to)) {
+        throw std::invalid_argument("Vertex number must be 0 to n - 1.");
+    }
+
+    adjacency_list_[from].push_back(to);
+    reverse_adjacency_list_[to].push_back(from);
+    ++num_edges_;
+
+    if (!dynamic_order_valid_) {
+        InitializeDynamicOrder();
+    } else if (from == to) {
+        ++num_self_loops_;
+    } else {
+        AddEdgeToDynamicOrder(from, to);
+    }
+}
+
+void DirectedGraph::RemoveEdge(int from, int to) {
+    if (InvalidVertexNumber(from) || InvalidVertexNumber(to)) {
+        throw std::invalid_argument("Vertex number must be 0 to n - 1.");
+    }
+
+    auto itr = std::find(adjacency_list_[from].begin(),
+                         adjacency_list_[from].end(), to);
+    if (itr == adjacency_list_[from].end()) {
+        throw std::invalid_argument("Edge does not exist.");
+    }
+    adjacency_list_[from].erase(itr);
+    reverse_adjacency_list_[to].erase(
+        std::find(reverse_adjacency_list_[to].begin(),
+                  reverse_adjacency_list_[to].end(), from));
+    --num_edges_;
+
+    // Removing an edge between different components keeps the order valid.
+    if (!dynamic_order_valid_ || component_[from] == component_[to]) {
+        if (from == to) {
+            --num_self_loops_;
+        } else {
+            InitializeDynamicOrder();
+        }
+    }
+}
+
+void DirectedGraph::ReverseEdge(int from, int to) {
+    RemoveEdge(from, to);
+    AddEdge(to, from);
+}
+
 DirectedGraph DirectedGraph::CreateSubgraph(
     const std::vector<int>& vertices) const {
     std::unordered_set<int> vertices_set(vertices.begin(), vertices.end());
@@ -230,9 +441,263 @@ DirectedGraph DirectedGraph::DeleteCyclesOfLength2() const {
     return DirectedGraph(result_edges, num_vertices_);
 }
 
+std::vector<int> DirectedGraph::VertexOrdering(VertexOrder order) const {
+    switch (order) {
+        case VertexOrder::kTopological:
+            return TopologicalOrder();
+        case VertexOrder::kBreadthFirst:
+            return BreadthFirstOrder(false);
+        case VertexOrder::kReverseCuthillMcKee: {
+            std::vector<int> ordering = BreadthFirstOrder(true);
+            std::reverse(ordering.begin(), ordering.end());
+            return ordering;
+        }
+    }
+    throw std::invalid_argument("Unknown vertex order.");
+}
+
+DirectedGraph DirectedGraph::Relabel(const std::vector<int>& new_number) const {
+    if (new_number.size() != num_vertices_) {
+        throw std::invalid_argument("New numbers must be a permutation.");
+    }
+    std::vector<int> original_number(num_vertices_, -1);
+    for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+        if (InvalidVertexNumber(new_number[vertex]) ||
+            original_number[new_number[vertex]] != -1) {
+            throw std::invalid_argument("New numbers must be a permutation.");
+        }
+        original_number[new_number[vertex]] = vertex;
+    }
+
+    // Adding the edges in the new order lays the adjacency lists out in the
+    // new order as well.
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(num_edges_);
+    for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+        for (auto& adjacent_vertex :
+             adjacency_list_[original_number[vertex]]) {
+            edges.push_back({vertex, new_number[adjacent_vertex]});
+        }
+    }
+    return DirectedGraph(edges, num_vertices_);
+}
+
+RelabeledGraph DirectedGraph::Reorder(VertexOrder order) const {
+    RelabeledGraph result;
+    result.original_number = VertexOrdering(order);
+    result.new_number.assign(num_vertices_, 0);
+    for (int i = 0; i < num_vertices_; ++i) {
+        result.new_number[result.original_number[i]] = i;
+    }
+    result.graph = Relabel(result.new_number);
+    return result;
+}
+
+std::vector<int> DirectedGraph::BreadthFirstOrder(bool by_degree) const {
+    std::vector<int> degree(num_vertices_);
+    for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+        degree[vertex] = adjacency_list_[vertex].size() +
+                         reverse_adjacency_list_[vertex].size();
+    }
+
+    std::vector<int> start_vertices(num_vertices_);
+    for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+        start_vertices[vertex] = vertex;
+    }
+    if (by_degree) {
+        std::stable_sort(start_vertices.begin(), start_vertices.end(),
+                         [&degree](int vertex1, int vertex2) {
+                             return degree[vertex1] < degree[vertex2];
+                         });
+    }
+
+    std::vector<int> ordering;
+    ordering.reserve(num_vertices_);
+    std::vector<bool> is_visited(num_vertices_, false);
+    std::vector<int> neighbors;
+    for (auto& start_vertex : start_vertices) {
+        if (is_visited[start_vertex]) {
+            continue;
+        }
+        is_visited[start_vertex] = true;
+        ordering.push_back(start_vertex);
+
+        // ordering doubles as the queue of the search.
+        for (int head = ordering.size() - 1; head < ordering.size(); ++head) {
+            int vertex = ordering[head];
+            neighbors.clear();
+            for (auto& adjacent_vertex : adjacency_list_[vertex]) {
+                if (!is_visited[adjacent_vertex]) {
+                    is_visited[adjacent_vertex] = true;
+                    neighbors.push_back(adjacent_vertex);
+                }
+            }
+            for (auto& adjacent_vertex : reverse_adjacency_list_[vertex]) {
+                if (!is_visited[adjacent_vertex]) {
+                    is_visited[adjacent_vertex] = true;
+                    neighbors.push_back(adjacent_vertex);
+                }
+            }
+            if (by_degree) {
+                std::stable_sort(neighbors.begin(), neighbors.end(),
+                                 [&degree](int vertex1, int vertex2) {
+                                     return degree[vertex1] < degree[vertex2];
+                                 });
+            }
+            ordering.insert(ordering.end(), neighbors.begin(),
+                            neighbors.end());
+        }
+    }
+    return ordering;
+}
+
+void DirectedGraph::InitializeDynamicOrder() {
+    dynamic_order_valid_ = false;
+    std::vector<std::vector<int>> components = StronglyConnectedComponents();
+
+    num_components_ = components.size();
+    num_self_loops_ = 0;
+    component_.assign(num_vertices_, 0);
+    component_members_.assign(num_vertices_, std::vector<int>());
+    component_order_.assign(num_vertices_, 0);
+    forward_mark_.assign(num_vertices_, 0);
+    backward_mark_.assign(num_vertices_, 0);
+    search_epoch_ = 0;
+
+    // Kosaraju's algorithm finds the components in topological order.
+    for (int i = 0; i < components.size(); ++i) {
+        int representative = components[i][0];
+        component_order_[representative] = i;
+        for (auto& vertex : components[i]) {
+            component_[vertex] = representative;
+        }
+        component_members_[representative] = components[i];
+    }
+
+    for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+        num_self_loops_ += std::count(adjacency_list_[vertex].begin(),
+                                      adjacency_list_[vertex].end(), vertex);
+    }
+    dynamic_order_valid_ = true;
+}
+
+/* Pearce-Kelly: only the components positioned between the endpoints of the
+ * new edge are searched and reordered. The components that reach from_component
+ * move in front of the ones reachable from to_component, reusing their
+ * positions. Components found by both searches lie on a new cycle and are
+ * merged into one component placed between the two groups. */
+void DirectedGraph::AddEdgeToDynamicOrder(int from, int to) {
+    int from_component = component_[from];
+    int to_component = component_[to];
+    int upper_bound = component_order_[from_component];
+    int lower_bound = component_order_[to_component];
+    if (from_component == to_component || upper_bound < lower_bound) {
+        return;
+    }
+
+    ++search_epoch_;
+    std::vector<int> forward =
+        SearchComponents(to_component, upper_bound, true);
+    std::vector<int> backward =
+        SearchComponents(from_component, lower_bound, false);
+
+    std::vector<int> positions;
+    std::vector<int> forward_only;
+    std::vector<int> backward_only;
+    std::vector<int> cycle;
+    for (auto& component : forward) {
+        positions.push_back(component_order_[component]);
+        if (backward_mark_[component] == search_epoch_) {
+            cycle.push_back(component);
+        } else {
+            forward_only.push_back(component);
+        }
+    }
+    for (auto& component : backward) {
+        if (forward_mark_[component] != search_epoch_) {
+            positions.push_back(component_order_[component]);
+            backward_only.push_back(component);
+        }
+    }
+
+    auto by_order = [this](int component1, int component2) {
+        return component_order_[component1] < component_order_[component2];
+    };
+    std::sort(positions.begin(), positions.end());
+    std::sort(forward_only.begin(), forward_only.end(), by_order);
+    std::sort(backward_only.begin(), backward_only.end(), by_order);
+
+    for (int i = 0; i < backward_only.size(); ++i) {
+        component_order_[backward_only[i]] = positions[i];
+    }
+    int first_forward_position = positions.size() - forward_only.size();
+    for (int i = 0; i < forward_only.size(); ++i) {
+        component_order_[forward_only[i]] =
+            positions[first_forward_position + i];
+    }
+
+    if (cycle.empty()) {
+        return;
+    }
+
+    int representative = cycle[0];
+    for (auto& component : cycle) {
+        if (component_members_[component].size() >
+            component_members_[representative].size()) {
+            representative = component;
+        }
+    }
+    for (auto& component : cycle) {
+        if (component == representative) {
+            continue;
+        }
+        for (auto& vertex : component_members_[component]) {
+            component_[vertex] = representative;
+        }
+        component_members_[representative].insert(
+            component_members_[representative].end(),
+            component_members_[component].begin(),
+            component_members_[component].end());
+        component_members_[component].clear();
+    }
+    component_order_[representative] = positions[backward_only.size()];
+    num_components_ -= cycle.size() - 1;
+}
+
+std::vector<int> DirectedGraph::SearchComponents(int start_component,
+                                                 int bound, bool is_forward) {
+    std::vector<int>& mark = is_forward ? forward_mark_ : backward_mark_;
+    mark[start_component] = search_epoch_;
+    std::vector<int> found = {start_component};
+    std::vector<int> stack = {start_component};
+
+    while (!stack.empty()) {
+        int component = stack.back();
+        stack.pop_back();
+        for (auto& vertex : component_members_[component]) {
+            const std::vector<int>& neighbors =
+                is_forward ? adjacency_list_[vertex]
+                           : reverse_adjacency_list_[vertex];
+            for (auto& neighbor : neighbors) {
+                int next_component = component_[neighbor];
+                int order = component_order_[next_component];
+                if (mark[next_component] == search_epoch_ ||
+                    (is_forward ? order > bound : order < bound)) {
+                    continue;
+                }
+                mark[next_component] = search_epoch_;
+                found.push_back(next_component);
+                stack.push_back(next_component);
+            }
+        }
+    }
+    return found;
+}
+
 void DirectedGraph::PathSearch(
     int vertex, std::vector<std::vector<int>>& connected_components_list,
-    int component_index) const {
+    int component_index, Budget* budget) const {
+    CheckBudget(budget);
     connected_components_list[component_index].push_back(vertex);
     std::vector<int> current_component(
         connected_components_list[component_index]);
@@ -246,13 +711,13 @@ void DirectedGraph::PathSearch(
 
         if (first_time) {
             PathSearch(adjacent_vertex, connected_components_list,
-                       component_index);
+                       component_index, budget);
             first_time = false;
         } else {
             connected_components_list.push_back(
                 std::vector<int>(current_component));
             PathSearch(adjacent_vertex, connected_components_list,
-                       connected_components_list.size() - 1);
+                       connected_components_list.size() - 1, budget);
         }
     }
 }
@@ -296,18 +761,62 @@ void DirectedGraph::UnBlockJohnson(
     }
 }
 
+/* Every component with more than one vertex gives one task per vertex. The
+ * components are sorted, and task (c, i) searches the cycles whose smallest
+ * vertex is components[c][i]. */
+std::vector<std::pair<int, int>> DirectedGraph::CycleSearchTasks(
+    std::vector<std::vector<int>>& components) const {
+    std::vector<std::pair<int, int>> tasks;
+    for (int c = 0; c < components.size(); ++c) {
+        if (components[c].size() == 1) {
+            continue;
+        }
+
+        std::sort(components[c].begin(), components[c].end());
+        for (int i = 0; i < components[c].size(); ++i) {
+            tasks.push_back({c, i});
+        }
+    }
+    return tasks;
+}
+
+void DirectedGraph::SearchCyclesFrom(const std::vector<int>& component,
+                                     int start_index,
+                                     const CycleVisitor& visitor,
+                                     std::atomic<bool>& is_stopped,
+                                     Budget* budget) const {
+    std::unordered_set<int> blocked_set;
+    std::unordered_map<int, std::unordered_set<int>> blocked_map;
+    std::deque<int> stack;
+    DirectedGraph search_graph = CreateSubgraph(
+        std::vector<int>(component.begin() + start_index, component.end()));
+    FindCyclesInSCCJohnson(search_graph, blocked_set, blocked_map, stack,
+                           visitor, is_stopped, budget, component[start_index],
+                           component[start_index]);
+}
+
 /* Find all simple cycles starting with start_vertex using Johnson's algorithm
  */
 bool DirectedGraph::FindCyclesInSCCJohnson(
     const DirectedGraph& scc_graph, std::unordered_set<int>& blocked_set,
     std::unordered_map<int, std::unordered_set<int>>& blocked_map,
-    std::deque<int>& stack, std::vector<std::vector<int>>& cycles,
-    int start_vertex, int current_vertex) const {
+    std::deque<int>& stack, const CycleVisitor& visitor,
+    std::atomic<bool>& is_stopped, Budget* budget, int start_vertex,
+    int current_vertex) const {
+    if (budget != nullptr && budget->Expired()) {
+        is_stopped.store(true, std::memory_order_relaxed);
+        return false;
+    }
+
     bool found_cycle = false;
     stack.push_back(current_vertex);
     blocked_set.insert(current_vertex);
 
     for (auto& adjacent_vertex : scc_graph.AdjacentVertices(current_vertex)) {
+        if (is_stopped.load(std::memory_order_relaxed)) {
+            break;
+        }
+
         if (adjacent_vertex < start_vertex) {
             continue;
         }
@@ -315,13 +824,15 @@ bool DirectedGraph::FindCyclesInSCCJohnson(
         if (adjacent_vertex == start_vertex) {
             stack.push_back(start_vertex);
             std::vector<int> cycle(stack.begin(), stack.end());
-            cycles.push_back(cycle);
+            if (!visitor(cycle)) {
+                is_stopped.store(true, std::memory_order_relaxed);
+            }
             stack.pop_back();
             found_cycle = true;
         } else if (blocked_set.count(adjacent_vertex) == 0) {
             bool got_cycle = FindCyclesInSCCJohnson(
-                scc_graph, blocked_set, blocked_map, stack, cycles,
-                start_vertex, adjacent_vertex);
+                scc_graph, blocked_set, blocked_map, stack, visitor,
+                is_stopped, budget, start_vertex, adjacent_vertex);
             found_cycle = found_cycle || got_cycle;
         }
     }
@@ -1,14 +1,29 @@
 #pragma once
 
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "budget.hpp"
+
 namespace FTMR {
+// Vertex orders for DirectedGraph::Reorder. kBreadthFirst and
+// kReverseCuthillMcKee ignore the direction of the edges, and the latter
+// visits the neighbors of each vertex in increasing order of degree.
+enum class VertexOrder { kTopological, kBreadthFirst, kReverseCuthillMcKee };
+
+struct RelabeledGraph;
+
 class DirectedGraph {
    public:
+    // Receives each simple cycle, with the start vertex repeated at the end.
+    // Returning false stops the search.
+    using CycleVisitor = std::function<bool(const std::vector<int>& cycle)>;
+
     DirectedGraph() = default;
 
     ~DirectedGraph() = default;
@@ -42,24 +57,99 @@ class DirectedGraph {
     // Returns true when the graph is DAG
     bool IsDAG() const;
 
+    // Returns true when the graph is a DAG with at most one path between
+    // any two vertices.
+    bool IsMultitree() const;
+
+    // Throws DeadlineExceeded if the budget runs out.
+    bool IsMultitree(Budget& budget) const;
+
     // Returns unilaterally connected components of the graph.
     // This function only work when the graph is DAG
     std::vector<std::vector<int>> UnilaterallyConnectedComponents() const;
 
+    // Throws DeadlineExceeded if the budget runs out.
+    std::vector<std::vector<int>> UnilaterallyConnectedComponents(
+        Budget& budget) const;
+
     std::vector<std::vector<int>> StronglyConnectedComponents() const;
 
     std::vector<std::vector<int>> SimpleCycles() const;
 
+    // Same cycles in the same order as SimpleCycles(), found by searching
+    // from the start vertices of every strongly connected component on
+    // num_threads threads.
+    std::vector<std::vector<int>> SimpleCycles(int num_threads) const;
+
+    // Calls visitor with every simple cycle until it returns false. With
+    // more than one thread the visitor is called concurrently, in no
+    // particular order, and must be thread-safe. Returns false if the
+    // visitor stopped the search.
+    bool VisitSimpleCycles(const CycleVisitor& visitor,
+                           int num_threads) const;
+
+    // Budgeted versions. The budget is checked at every step of the searches
+    // and DeadlineExceeded is thrown once it runs out.
+    std::vector<std::vector<int>> SimpleCycles(int num_threads,
+                                               Budget& budget) const;
+
+    bool VisitSimpleCycles(const CycleVisitor& visitor, int num_threads,
+                           Budget& budget) const;
+
+    // Returns the vertices ordered so that every edge between different
+    // strongly connected components goes forward. When the graph is a DAG
+    // this is a topological order.
+    std::vector<int> TopologicalOrder() const;
+
+    // Edits the graph. After the first edit, the strongly connected
+    // components and their topological order are maintained incrementally
+    // (Pearce-Kelly), so IsDAG, StronglyConnectedComponents and
+    // TopologicalOrder do not search the whole graph again.
+    void AddEdge(int from, int to);
+
+    // Removes one edge from -> to. Throws std::invalid_argument if there is
+    // no such edge. Removing an edge inside a strongly connected component
+    // recomputes the components from scratch.
+    void RemoveEdge(int from, int to);
+
+    void ReverseEdge(int from, int to);
+
     DirectedGraph CreateSubgraph(const std::vector<int>& vertices) const;
 
     DirectedGraph DeleteCyclesOfLength2() const;
 
+    // Returns the vertices in the given order.
+    std::vector<int> VertexOrdering(VertexOrder order) const;
+
+    // Returns the graph with vertex v renumbered new_number[v]. The edges
+    // keep their order within each adjacency list. Throws
+    // std::invalid_argument if new_number is not a permutation of 0 to
+    // n - 1.
+    DirectedGraph Relabel(const std::vector<int>& new_number) const;
+
+    // Renumbers the vertices in the given order, so that searches over
+    // neighboring vertices touch nearby adjacency lists.
+    RelabeledGraph Reorder(VertexOrder order) const;
+
    private:
     int num_vertices_;
     int num_edges_;
     std::vector<std::vector<int>> adjacency_list_;
     std::vector<std::vector<int>> reverse_adjacency_list_;
 
+    // Incremental state, built on the first edit. Each strongly connected
+    // component is identified by a representative vertex, and the
+    // representatives have distinct positions in topological order.
+    bool dynamic_order_valid_ = false;
+    int num_components_ = 0;
+    int num_self_loops_ = 0;
+    std::vector<int> component_;
+    std::vector<std::vector<int>> component_members_;
+    std::vector<int> component_order_;
+    std::vector<int> forward_mark_;
+    std::vector<int> backward_mark_;
+    int search_epoch_ = 0;
+
     bool InvalidVertexNumber(int vertex) const {
         return vertex < 0 || vertex >= num_vertices_;
     }
@@ -68,7 +158,34 @@ class DirectedGraph {
     // DFS.
     void PathSearch(int vertex,
                     std::vector<std::vector<int>>& connected_components_list,
-                    int component_index) const;
+                    int component_index, Budget* budget) const;
+
+    bool IsMultitree(Budget* budget) const;
+
+    std::vector<std::vector<int>> UnilaterallyConnectedComponents(
+        Budget* budget) const;
+
+    std::vector<std::vector<int>> SimpleCycles(int num_threads,
+                                               Budget* budget) const;
+
+    bool VisitSimpleCycles(const CycleVisitor& visitor, int num_threads,
+                           Budget* budget) const;
+
+    void InitializeDynamicOrder();
+
+    // Restores the topological order of the components after adding the
+    // edge from -> to, merging the components on a new cycle.
+    void AddEdgeToDynamicOrder(int from, int to);
+
+    // Returns the components reachable from start_component (forward) or
+    // reaching it (backward) whose position does not pass bound.
+    std::vector<int> SearchComponents(int start_component, int bound,
+                                      bool is_forward);
+
+    // Breadth-first order of the underlying undirected graph. With
+    // by_degree, every component starts at a vertex of minimum degree and
+    // the neighbors are visited in increasing order of degree.
+    std::vector<int> BreadthFirstOrder(bool by_degree) const;
 
     void DFSForSCC(std::vector<bool>& is_visited,
                    std::deque<int>& finished_vertices, int vertex) const;
@@ -81,10 +198,28 @@ class DirectedGraph {
         std::unordered_map<int, std::unordered_set<int>>& blocked_map,
         int vertex) const;
 
+    // Returns the (component, start index) pairs of the Johnson searches.
+    std::vector<std::pair<int, int>> CycleSearchTasks(
+        std::vector<std::vector<int>>& components) const;
+
+    // Runs the Johnson search of one task, with its own blocked sets.
+    void SearchCyclesFrom(const std::vector<int>& component, int start_index,
+                          const CycleVisitor& visitor,
+                          std::atomic<bool>& is_stopped, Budget* budget) const;
+
     bool FindCyclesInSCCJohnson(
         const DirectedGraph& scc_graph, std::unordered_set<int>& blocked_set,
         std::unordered_map<int, std::unordered_set<int>>& blocked_map,
-        std::deque<int>& stack, std::vector<std::vector<int>>& cycles,
-        int start_vertex, int current_vertex) const;
+        std::deque<int>& stack, const CycleVisitor& visitor,
+        std::atomic<bool>& is_stopped, Budget* budget, int start_vertex,
+        int current_vertex) const;
+};
+
+// Vertex v of the original graph is new_number[v] in graph, and vertex u of
+// graph is original_number[u] in the original graph.
+struct RelabeledGraph {
+    DirectedGraph graph;
+    std::vector<int> new_number;
+    std::vector<int> original_number;
 };
 }  // namespace FTMR
\ No newline at end of file
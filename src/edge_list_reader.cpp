@@ -0,0 +1,59 @@
+#include "edge_list_reader.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace FTMR {
+bool EdgeListReader::Next(EdgeListRecord& record) {
+    int num_vertices;
+    if (!NextInteger(num_vertices)) {
+        return false;
+    }
+
+    int num_edges;
+    if (!NextInteger(num_edges) || num_vertices <= 0 || num_edges < 0) {
+        throw std::runtime_error("Invalid edge list record.");
+    }
+
+    record.num_vertices = num_vertices;
+    record.edges.resize(num_edges);
+    for (auto& edge : record.edges) {
+        if (!NextInteger(edge.first) || !NextInteger(edge.second)) {
+            throw std::runtime_error("Invalid edge list record.");
+        }
+    }
+    return true;
+}
+
+void EdgeListReader::SkipRecord() {
+    input_.clear();
+    std::string line;
+    std::getline(input_, line);
+    while (input_.peek() != 'G' && std::getline(input_, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            return;
+        }
+    }
+    input_.clear(input_.rdstate() & ~std::ios::failbit);
+}
+
+bool EdgeListReader::NextInteger(int& value) {
+    while (true) {
+        input_ >> std::ws;
+        if (input_.eof()) {
+            return false;
+        }
+
+        if (input_.peek() == 'G') {
+            std::string header;
+            std::getline(input_, header);
+            continue;
+        }
+
+        if (!(input_ >> value)) {
+            throw std::runtime_error("Invalid edge list record.");
+        }
+        return true;
+    }
+}
+}  // namespace FTMR
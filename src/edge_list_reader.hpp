@@ -0,0 +1,46 @@
+#pragma once
+
+#include <istream>
+#include <utility>
+#include <vector>
+
+namespace FTMR {
+
+struct EdgeListRecord {
+    int num_vertices;
+    std::vector<std::pair<int, int>> edges;
+};
+
+// Reads a stream of edge-list records in the format of the trees data files:
+//
+//   Graph 1, order 5.
+//   5 4
+//   0 4  1 4  2 4  3 4
+//
+// A record is the number of vertices and edges followed by the edges. The
+// "Graph" header lines are optional and ignored, and the edges may be split
+// over several lines.
+class EdgeListReader {
+   public:
+    explicit EdgeListReader(std::istream& input) : input_(input) {}
+
+    ~EdgeListReader() = default;
+
+    // Reads the next record into record, reusing its storage. Returns false
+    // at the end of the stream, and throws std::runtime_error on a malformed
+    // record.
+    bool Next(EdgeListRecord& record);
+
+    // Recovers after Next threw: discards the rest of the malformed record,
+    // which is everything up to the next blank line or "Graph" header line.
+    void SkipRecord();
+
+   private:
+    std::istream& input_;
+
+    // Reads the next integer, skipping header lines. Returns false at the end
+    // of the stream.
+    bool NextInteger(int& value);
+};
+
+}  // namespace FTMR
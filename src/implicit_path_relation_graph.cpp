@@ -0,0 +1,392 @@
+#include "implicit_path_relation_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace FTMR {
+ImplicitPathRelationGraph::ImplicitPathRelationGraph(
+    const DirectedGraph& multitree) {
+    Initialize(multitree);
+}
+
+ImplicitPathRelationGraph::ImplicitPathRelationGraph(
+    const std::vector<std::pair<int, int>>& edges, int num_vertices) {
+    Initialize(DirectedGraph(edges, num_vertices));
+}
+
+void ImplicitPathRelationGraph::Initialize(const DirectedGraph& multitree) {
+    if (!multitree.IsDAG()) {
+        throw std::runtime_error("The graph must be a DAG.");
+    }
+
+    num_vertices_ = multitree.NumVertices();
+    children_.assign(num_vertices_, std::vector<int>());
+    for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+        children_[vertex] = multitree.AdjacentVertices(vertex);
+    }
+
+    // One DFS per vertex. The visit marks are stamped with the start vertex
+    // so they never need to be cleared.
+    std::vector<int> visited(num_vertices_, -1);
+    std::vector<int> stack;
+    std::vector<std::vector<int>> ancestor_lists(num_vertices_);
+    descendant_offsets_.assign(1, 0);
+    for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+        int begin = descendants_.size();
+        visited[vertex] = vertex;
+        stack.push_back(vertex);
+        while (!stack.empty()) {
+            int current_vertex = stack.back();
+            stack.pop_back();
+            descendants_.push_back(current_vertex);
+            ancestor_lists[current_vertex].push_back(vertex);
+            for (auto& child : children_[current_vertex]) {
+                if (visited[child] != vertex) {
+                    visited[child] = vertex;
+                    stack.push_back(child);
+                }
+            }
+        }
+        std::sort(descendants_.begin() + begin, descendants_.end());
+        descendant_offsets_.push_back(descendants_.size());
+    }
+
+    // The ancestor lists are filled in increasing order of the ancestor.
+    ancestor_offsets_.assign(1, 0);
+    for (auto& ancestor_list : ancestor_lists) {
+        ancestors_.insert(ancestors_.end(), ancestor_list.begin(),
+                          ancestor_list.end());
+        ancestor_offsets_.push_back(ancestors_.size());
+    }
+}
+
+bool ImplicitPathRelationGraph::Reaches(int vertex_start,
+                                        int vertex_end) const {
+    return std::binary_search(
+        descendants_.begin() + descendant_offsets_[vertex_start],
+        descendants_.begin() + descendant_offsets_[vertex_start + 1],
+        vertex_end);
+}
+
+int ImplicitPathRelationGraph::GetPathNumber(int first, int last) const {
+    auto begin = descendants_.begin() + descendant_offsets_[first];
+    auto end = descendants_.begin() + descendant_offsets_[first + 1];
+    auto itr = std::lower_bound(begin, end, last);
+    if (itr == end || *itr != last) {
+        return -1;
+    }
+    return std::distance(descendants_.begin(), itr);
+}
+
+std::pair<int, int> ImplicitPathRelationGraph::GetPath(
+    int path_number) const {
+    int first = std::upper_bound(descendant_offsets_.begin(),
+                                 descendant_offsets_.end(), path_number) -
+                descendant_offsets_.begin() - 1;
+    return {first, descendants_[path_number]};
+}
+
+bool ImplicitPathRelationGraph::IsAdjacent(int path_number1,
+                                           int path_number2) const {
+    if (path_number1 == path_number2) {
+        return false;
+    }
+
+    std::pair<int, int> path1 = GetPath(path_number1);
+    std::pair<int, int> path2 = GetPath(path_number2);
+    return (Reaches(path1.first, path2.first) &&
+            Reaches(path2.first, path1.second)) ||
+           (Reaches(path2.first, path1.second) &&
+            Reaches(path1.second, path2.second));
+}
+
+int ImplicitPathRelationGraph::NextVertexOnPath(int vertex,
+                                                int vertex_end) const {
+    for (auto& child : children_[vertex]) {
+        if (Reaches(child, vertex_end)) {
+            return child;
+        }
+    }
+    return vertex;
+}
+
+int ImplicitPathRelationGraph::GetNextStepPathNumber(int path_number) const {
+    std::pair<int, int> path = GetPath(path_number);
+    if (path.first == path.second) {
+        return path_number;
+    }
+    return GetPathNumber(NextVertexOnPath(path.first, path.second),
+                         path.second);
+}
+
+/* The out-neighbors of (a1, b1) are
+ *   phase 0: (x, y) with x on (a1, b1) and y reachable from x,
+ *   phase 1: (a2, b2) with a2 reaching b1 and b1 reaching b2, skipping the
+ *            paths already listed in phase 0 (a2 on (a1, b1)). */
+bool ImplicitPathRelationGraph::NextAdjacentPath(int path_number,
+                                                 NeighborCursor& cursor,
+                                                 int& neighbor) const {
+    std::pair<int, int> path = GetPath(path_number);
+    if (cursor.phase < 0) {
+        cursor = NeighborCursor();
+        cursor.phase = 0;
+        cursor.vertex = path.first;
+    }
+
+    while (cursor.phase == 0) {
+        int x = cursor.vertex;
+        int num_descendants =
+            descendant_offsets_[x + 1] - descendant_offsets_[x];
+        if (cursor.index2 < num_descendants) {
+            neighbor = descendant_offsets_[x] + cursor.index2++;
+            if (neighbor != path_number) {
+                return true;
+            }
+        } else if (x != path.second) {
+            cursor.vertex = NextVertexOnPath(x, path.second);
+            cursor.index2 = 0;
+        } else {
+            cursor.phase = 1;
+            cursor.index1 = 0;
+            cursor.index2 = 0;
+        }
+    }
+
+    int b1 = path.second;
+    int num_ancestors = ancestor_offsets_[b1 + 1] - ancestor_offsets_[b1];
+    int num_descendants = descendant_offsets_[b1 + 1] - descendant_offsets_[b1];
+    while (cursor.index1 < num_ancestors) {
+        int a2 = ancestors_[ancestor_offsets_[b1] + cursor.index1];
+        if (cursor.index2 == 0 && Reaches(path.first, a2)) {
+            ++cursor.index1;
+            continue;
+        }
+        if (cursor.index2 < num_descendants) {
+            int b2 = descendants_[descendant_offsets_[b1] + cursor.index2++];
+            neighbor = GetPathNumber(a2, b2);
+            return true;
+        }
+        ++cursor.index1;
+        cursor.index2 = 0;
+    }
+    return false;
+}
+
+/* The in-neighbors of (a2, b2) are
+ *   phase 0: (a1, b1) with a1 reaching a2 and a2 reaching b1,
+ *   phase 1: (a1, b1) with b1 on (a2, b2) and a1 reaching b1, skipping the
+ *            paths already listed in phase 0 (a1 reaching a2). */
+bool ImplicitPathRelationGraph::NextReverseAdjacentPath(
+    int path_number, NeighborCursor& cursor, int& neighbor) const {
+    std::pair<int, int> path = GetPath(path_number);
+    int a2 = path.first;
+    if (cursor.phase < 0) {
+        cursor = NeighborCursor();
+        cursor.phase = 0;
+    }
+
+    int num_ancestors = ancestor_offsets_[a2 + 1] - ancestor_offsets_[a2];
+    int num_descendants = descendant_offsets_[a2 + 1] - descendant_offsets_[a2];
+    while (cursor.phase == 0) {
+        if (cursor.index1 == num_ancestors) {
+            cursor.phase = 1;
+            cursor.vertex = a2;
+            cursor.index1 = 0;
+            break;
+        }
+        if (cursor.index2 == num_descendants) {
+            ++cursor.index1;
+            cursor.index2 = 0;
+            continue;
+        }
+        int a1 = ancestors_[ancestor_offsets_[a2] + cursor.index1];
+        int b1 = descendants_[descendant_offsets_[a2] + cursor.index2++];
+        neighbor = GetPathNumber(a1, b1);
+        if (neighbor != path_number) {
+            return true;
+        }
+    }
+
+    while (true) {
+        int b1 = cursor.vertex;
+        int begin = ancestor_offsets_[b1];
+        int end = ancestor_offsets_[b1 + 1];
+        while (begin + cursor.index1 < end) {
+            int a1 = ancestors_[begin + cursor.index1++];
+            if (!Reaches(a1, a2)) {
+                neighbor = GetPathNumber(a1, b1);
+                return true;
+            }
+        }
+        if (b1 == path.second) {
+            return false;
+        }
+        cursor.vertex = NextVertexOnPath(b1, path.second);
+        cursor.index1 = 0;
+    }
+}
+
+bool ImplicitPathRelationGraph::NextAdjacentPathWithout2Cycles(
+    int path_number, NeighborCursor& cursor, int& neighbor) const {
+    while (NextAdjacentPath(path_number, cursor, neighbor)) {
+        if (!IsAdjacent(neighbor, path_number)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Tarjan's algorithm with an explicit stack of neighbor cursors. */
+std::vector<int> ImplicitPathRelationGraph::StronglyConnectedComponentNumbers()
+    const {
+    struct Frame {
+        int path_number;
+        NeighborCursor cursor;
+    };
+
+    int num_paths = NumPaths();
+    std::vector<int> component_numbers(num_paths, -1);
+    std::vector<int> index(num_paths, -1);
+    std::vector<int> lowlink(num_paths, 0);
+    std::vector<bool> is_on_stack(num_paths, false);
+    std::vector<int> stack;
+    std::vector<Frame> frames;
+    int next_index = 0;
+    int num_components = 0;
+
+    auto visit = [&](int path_number) {
+        index[path_number] = lowlink[path_number] = next_index++;
+        stack.push_back(path_number);
+        is_on_stack[path_number] = true;
+        frames.push_back(Frame{path_number, NeighborCursor()});
+    };
+
+    for (int start = 0; start < num_paths; ++start) {
+        if (index[start] != -1) {
+            continue;
+        }
+
+        visit(start);
+        while (!frames.empty()) {
+            int path_number = frames.back().path_number;
+            int neighbor;
+            if (NextAdjacentPathWithout2Cycles(
+                    path_number, frames.back().cursor, neighbor)) {
+                if (index[neighbor] == -1) {
+                    visit(neighbor);
+                } else if (is_on_stack[neighbor]) {
+                    lowlink[path_number] =
+                        std::min(lowlink[path_number], index[neighbor]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) {
+                int parent = frames.back().path_number;
+                lowlink[parent] =
+                    std::min(lowlink[parent], lowlink[path_number]);
+            }
+            if (lowlink[path_number] == index[path_number]) {
+                int member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    is_on_stack[member] = false;
+                    component_numbers[member] = num_components;
+                } while (member != path_number);
+                ++num_components;
+            }
+        }
+    }
+
+    return component_numbers;
+}
+
+/* For a path p, the check of MultitreeRecolorability::CheckConditionCPOnPath
+ * fails for a pair (q, r) iff q fails IsAdjacent(q, next(p)) and r fails
+ * IsReachable(next(p).first, r.second), so the two sides are searched
+ * separately. */
+bool ImplicitPathRelationGraph::CheckConditionCP() const {
+    std::vector<int> component_numbers = StronglyConnectedComponentNumbers();
+
+    for (int path_number = 0; path_number < NumPaths(); ++path_number) {
+        int component_number = component_numbers[path_number];
+        int next_step_path_number = GetNextStepPathNumber(path_number);
+        int next_step_first = GetPath(next_step_path_number).first;
+
+        bool has_bad_adjacent = false;
+        NeighborCursor cursor;
+        int neighbor;
+        while (NextAdjacentPath(path_number, cursor, neighbor)) {
+            if (component_numbers[neighbor] == component_number &&
+                !IsAdjacent(neighbor, next_step_path_number)) {
+                has_bad_adjacent = true;
+                break;
+            }
+        }
+        if (!has_bad_adjacent) {
+            continue;
+        }
+
+        cursor = NeighborCursor();
+        while (NextReverseAdjacentPath(path_number, cursor, neighbor)) {
+            if (component_numbers[neighbor] == component_number &&
+                !IsReachable(next_step_first, GetPath(neighbor).second)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* (CV) fails iff the edges p -> q of the PRG without cycles of length 2 with
+ * IsAdjacent(q, next(p)) contain a cycle, found here by an iterative DFS. */
+bool ImplicitPathRelationGraph::CheckConditionCV() const {
+    enum : char { kUnvisited, kOnStack, kFinished };
+    struct Frame {
+        int path_number;
+        int next_step_path_number;
+        NeighborCursor cursor;
+    };
+
+    std::vector<char> state(NumPaths(), kUnvisited);
+    std::vector<Frame> frames;
+    auto visit = [&](int path_number) {
+        state[path_number] = kOnStack;
+        frames.push_back(Frame{path_number, GetNextStepPathNumber(path_number),
+                               NeighborCursor()});
+    };
+
+    for (int start = 0; start < NumPaths(); ++start) {
+        if (state[start] != kUnvisited) {
+            continue;
+        }
+
+        visit(start);
+        while (!frames.empty()) {
+            Frame& frame = frames.back();
+            int neighbor;
+            if (!NextAdjacentPathWithout2Cycles(frame.path_number,
+                                                frame.cursor, neighbor)) {
+                state[frame.path_number] = kFinished;
+                frames.pop_back();
+                continue;
+            }
+            if (!IsAdjacent(neighbor, frame.next_step_path_number)) {
+                continue;
+            }
+
+            if (state[neighbor] == kOnStack) {
+                return false;
+            }
+            if (state[neighbor] == kUnvisited) {
+                visit(neighbor);
+            }
+        }
+    }
+
+    return true;
+}
+}  // namespace FTMR
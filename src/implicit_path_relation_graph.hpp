@@ -0,0 +1,102 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "directed_graph.hpp"
+
+namespace FTMR {
+
+// Path relation graph of a multitree that is never materialized.
+//
+// The vertices are the paths (a, b) with b reachable from a (a == b
+// included), and (a1, b1) -> (a2, b2) is an edge iff a2 is on (a1, b1) or
+// b1 is on (a2, b2). In a multitree the path between two vertices is unique,
+// so x is on (a, b) iff a reaches x and x reaches b. Neighbors are computed
+// on the fly from the sorted descendant and ancestor lists, so the memory is
+// linear in the number of paths instead of the number of PRG edges.
+class ImplicitPathRelationGraph {
+   public:
+    // Position of an enumeration of the neighbors of one path. A default
+    // constructed cursor starts at the first neighbor.
+    struct NeighborCursor {
+        int phase = -1;
+        int vertex = 0;
+        int index1 = 0;
+        int index2 = 0;
+    };
+
+    ImplicitPathRelationGraph() = default;
+
+    ~ImplicitPathRelationGraph() = default;
+
+    // Throws std::runtime_error if the graph is not a DAG.
+    explicit ImplicitPathRelationGraph(const DirectedGraph& multitree);
+
+    ImplicitPathRelationGraph(const std::vector<std::pair<int, int>>& edges,
+                              int num_vertices);
+
+    int NumPaths() const { return descendants_.size(); }
+
+    // Returns the number of the path (first, last), or -1 if last is not
+    // reachable from first.
+    int GetPathNumber(int first, int last) const;
+
+    std::pair<int, int> GetPath(int path_number) const;
+
+    // Returns true if and only if vertex_end is reachable from vertex_start
+    // by a non-empty path.
+    bool IsReachable(int vertex_start, int vertex_end) const {
+        return vertex_start != vertex_end && Reaches(vertex_start, vertex_end);
+    }
+
+    bool IsAdjacent(int path_number1, int path_number2) const;
+
+    // Returns the path one step shorter at the front, or the path itself if
+    // it has a single vertex.
+    int GetNextStepPathNumber(int path_number) const;
+
+    // Writes the next out- or in-neighbor of the path to neighbor and
+    // advances the cursor. Returns false when there are no more neighbors.
+    bool NextAdjacentPath(int path_number, NeighborCursor& cursor,
+                          int& neighbor) const;
+
+    bool NextReverseAdjacentPath(int path_number, NeighborCursor& cursor,
+                                 int& neighbor) const;
+
+    // Returns the number of the strongly connected component of every path
+    // in the PRG without cycles of length 2.
+    std::vector<int> StronglyConnectedComponentNumbers() const;
+
+    bool CheckConditionCP() const;
+
+    // Same method as MultitreeRecolorability::CheckConditionCVPolynomial.
+    bool CheckConditionCV() const;
+
+   private:
+    int num_vertices_;
+    std::vector<std::vector<int>> children_;
+
+    // descendants_[descendant_offsets_[a] ...] lists the vertices reachable
+    // from a in increasing order, a included. The number of path (a, b) is
+    // the position of b in that list. ancestors_ is the same for reverse
+    // reachability.
+    std::vector<int> descendant_offsets_;
+    std::vector<int> descendants_;
+    std::vector<int> ancestor_offsets_;
+    std::vector<int> ancestors_;
+
+    void Initialize(const DirectedGraph& multitree);
+
+    bool Reaches(int vertex_start, int vertex_end) const;
+
+    // Returns the vertex after vertex on the path to vertex_end.
+    int NextVertexOnPath(int vertex, int vertex_end) const;
+
+    // Out-neighbors in the PRG without cycles of length 2.
+    bool NextAdjacentPathWithout2Cycles(int path_number,
+                                        NeighborCursor& cursor,
+                                        int& neighbor) const;
+};
+
+}  // namespace FTMR
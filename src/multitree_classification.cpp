@@ -0,0 +1,60 @@
+#include "multitree_classification.hpp"
+
+#include "multitree_recolorability.hpp"
+
+namespace FTMR {
+namespace {
+TypeOfMultitree Classify(MultitreeRecolorability& multitree) {
+    if (multitree.CheckConditionS()) {
+        return TypeOfMultitree::kS;
+    } else if (multitree.CheckConditionCPBitParallel()) {
+        return TypeOfMultitree::kCPNotS;
+    } else if (multitree.CheckConditionCVPolynomial()) {
+        return TypeOfMultitree::kCVNotCP;
+    } else {
+        return TypeOfMultitree::kNotTractable;
+    }
+}
+}  // namespace
+
+TypeOfMultitree ClassifyMultitree(const std::vector<std::pair<int, int>>& edges,
+                                  int num_vertices) {
+    MultitreeRecolorability multitree(edges, num_vertices);
+    return Classify(multitree);
+}
+
+TypeOfMultitree ClassifyMultitree(const PolytreeSkeleton& skeleton,
+                                  uint64_t flip_bits) {
+    MultitreeRecolorability multitree(skeleton, flip_bits);
+    return Classify(multitree);
+}
+
+bool ClassifyMultitree(const std::vector<std::pair<int, int>>& edges,
+                       int num_vertices, Budget& budget,
+                       TypeOfMultitree& type) {
+    TypeOfMultitree classified_type;
+    CheckResult result;
+    try {
+        MultitreeRecolorability multitree(edges, num_vertices, budget);
+        if ((result = multitree.CheckConditionS(budget)) !=
+            CheckResult::kNotSatisfied) {
+            classified_type = TypeOfMultitree::kS;
+        } else if ((result = multitree.CheckConditionCPBitParallel(budget)) !=
+                   CheckResult::kNotSatisfied) {
+            classified_type = TypeOfMultitree::kCPNotS;
+        } else if ((result = multitree.CheckConditionCVPolynomial(budget)) !=
+                   CheckResult::kNotSatisfied) {
+            classified_type = TypeOfMultitree::kCVNotCP;
+        } else {
+            classified_type = TypeOfMultitree::kNotTractable;
+        }
+    } catch (const DeadlineExceeded&) {
+        return false;
+    }
+    if (result == CheckResult::kUnknown) {
+        return false;
+    }
+    type = classified_type;
+    return true;
+}
+}  // namespace FTMR
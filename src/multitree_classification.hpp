@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "budget.hpp"
+#include "polytree_orientations.hpp"
+
+namespace FTMR {
+
+enum class TypeOfMultitree {
+    kS,
+    kCPNotS,
+    kCVNotCP,
+    kNotTractable,
+};
+
+// Returns the first of the conditions (S), (CP) and (CV) that the multitree
+// satisfies.
+TypeOfMultitree ClassifyMultitree(const std::vector<std::pair<int, int>>& edges,
+                                  int num_vertices);
+
+// Classifies orientation flip_bits of the skeleton's tree without building
+// its edge list first.
+TypeOfMultitree ClassifyMultitree(const PolytreeSkeleton& skeleton,
+                                  uint64_t flip_bits);
+
+// Same as the first, but gives up when the budget runs out. Returns false in
+// that case and leaves type unchanged.
+bool ClassifyMultitree(const std::vector<std::pair<int, int>>& edges,
+                       int num_vertices, Budget& budget, TypeOfMultitree& type);
+
+}  // namespace FTMR
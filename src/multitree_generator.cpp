@@ -0,0 +1,504 @@
+#include "multitree_generator.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <stdexcept>
+#include <thread>
+
+namespace FTMR {
+namespace {
+uint64_t Bit(int vertex) { return uint64_t(1) << vertex; }
+
+int PopCount(uint64_t mask) { return std::bitset<64>(mask).count(); }
+
+/* Canonical labeling by individualization and refinement. Leaves of the
+ * search tree are compared by their relabeled adjacency masks, and branches
+ * equivalent under twin transpositions or already found automorphisms are
+ * pruned. */
+class CanonicalLabeling {
+   public:
+    CanonicalLabeling(int num_vertices, const uint64_t* out,
+                      const uint64_t* in, std::vector<int> colors)
+        : num_vertices_(num_vertices), out_(out), in_(in) {
+        Refine(colors);
+        Search(colors);
+    }
+
+    const std::vector<uint64_t>& Certificate() const { return certificate_; }
+
+    // Returns the vertex at each canonical position.
+    const std::vector<int>& Labeling() const { return labeling_; }
+
+   private:
+    int num_vertices_;
+    const uint64_t* out_;
+    const uint64_t* in_;
+    std::vector<uint64_t> certificate_;
+    std::vector<int> labeling_;
+    std::vector<std::vector<int>> automorphisms_;
+    std::vector<int> individualized_;
+
+    int NumColors(const std::vector<int>& colors) const {
+        std::vector<int> sorted_colors(colors);
+        std::sort(sorted_colors.begin(), sorted_colors.end());
+        return std::unique(sorted_colors.begin(), sorted_colors.end()) -
+               sorted_colors.begin();
+    }
+
+    // Refines colors until every vertex of a color has the same multiset of
+    // out- and in-neighbor colors. Colors are renumbered 0 to k - 1 in an
+    // isomorphism invariant way.
+    void Refine(std::vector<int>& colors) const {
+        int num_colors = NumColors(colors);
+        while (true) {
+            std::vector<std::pair<std::vector<int>, int>> signatures;
+            for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+                std::vector<int> out_colors;
+                std::vector<int> in_colors;
+                for (int neighbor = 0; neighbor < num_vertices_; ++neighbor) {
+                    if (out_[vertex] & Bit(neighbor)) {
+                        out_colors.push_back(colors[neighbor]);
+                    }
+                    if (in_[vertex] & Bit(neighbor)) {
+                        in_colors.push_back(colors[neighbor]);
+                    }
+                }
+                std::sort(out_colors.begin(), out_colors.end());
+                std::sort(in_colors.begin(), in_colors.end());
+
+                std::vector<int> signature = {colors[vertex]};
+                signature.insert(signature.end(), out_colors.begin(),
+                                 out_colors.end());
+                signature.push_back(-1);
+                signature.insert(signature.end(), in_colors.begin(),
+                                 in_colors.end());
+                signatures.push_back({signature, vertex});
+            }
+            std::sort(signatures.begin(), signatures.end());
+
+            int new_num_colors = 0;
+            for (int i = 0; i < num_vertices_; ++i) {
+                if (i > 0 && signatures[i].first != signatures[i - 1].first) {
+                    ++new_num_colors;
+                }
+                colors[signatures[i].second] = new_num_colors;
+            }
+            ++new_num_colors;
+
+            if (new_num_colors == num_colors) {
+                return;
+            }
+            num_colors = new_num_colors;
+        }
+    }
+
+    // Returns true when swapping the two vertices is an automorphism.
+    bool IsTwin(int vertex1, int vertex2) const {
+        uint64_t mask = ~(Bit(vertex1) | Bit(vertex2));
+        bool edge12 = (out_[vertex1] & Bit(vertex2)) != 0;
+        bool edge21 = (out_[vertex2] & Bit(vertex1)) != 0;
+        return edge12 == edge21 &&
+               (out_[vertex1] & mask) == (out_[vertex2] & mask) &&
+               (in_[vertex1] & mask) == (in_[vertex2] & mask);
+    }
+
+    int FindRoot(std::vector<int>& parent, int vertex) const {
+        while (parent[vertex] != vertex) {
+            parent[vertex] = parent[parent[vertex]];
+            vertex = parent[vertex];
+        }
+        return vertex;
+    }
+
+    // Returns true if vertex is in the orbit of a tried vertex under the
+    // found automorphisms fixing every individualized vertex.
+    bool InTriedOrbit(int vertex, const std::vector<int>& tried) const {
+        std::vector<int> parent(num_vertices_);
+        for (int i = 0; i < num_vertices_; ++i) {
+            parent[i] = i;
+        }
+
+        for (auto& automorphism : automorphisms_) {
+            bool fixes_individualized = true;
+            for (auto& fixed_vertex : individualized_) {
+                if (automorphism[fixed_vertex] != fixed_vertex) {
+                    fixes_individualized = false;
+                    break;
+                }
+            }
+            if (!fixes_individualized) {
+                continue;
+            }
+
+            for (int i = 0; i < num_vertices_; ++i) {
+                parent[FindRoot(parent, i)] =
+                    FindRoot(parent, automorphism[i]);
+            }
+        }
+
+        for (auto& tried_vertex : tried) {
+            if (FindRoot(parent, tried_vertex) == FindRoot(parent, vertex)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Search(const std::vector<int>& colors) {
+        std::vector<int> color_size(num_vertices_, 0);
+        for (auto& color : colors) {
+            ++color_size[color];
+        }
+
+        int target_color = -1;
+        for (int color = 0; color < num_vertices_; ++color) {
+            if (color_size[color] > 1) {
+                target_color = color;
+                break;
+            }
+        }
+
+        if (target_color == -1) {
+            VisitLeaf(colors);
+            return;
+        }
+
+        std::vector<int> tried;
+        for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+            if (colors[vertex] != target_color) {
+                continue;
+            }
+
+            bool is_twin_of_tried = false;
+            for (auto& tried_vertex : tried) {
+                if (IsTwin(tried_vertex, vertex)) {
+                    is_twin_of_tried = true;
+                    break;
+                }
+            }
+            if (is_twin_of_tried || InTriedOrbit(vertex, tried)) {
+                continue;
+            }
+            tried.push_back(vertex);
+
+            std::vector<int> individualized_colors(num_vertices_);
+            for (int i = 0; i < num_vertices_; ++i) {
+                individualized_colors[i] =
+                    2 * colors[i] + (colors[i] == target_color && i != vertex);
+            }
+            Refine(individualized_colors);
+
+            individualized_.push_back(vertex);
+            Search(individualized_colors);
+            individualized_.pop_back();
+        }
+    }
+
+    void VisitLeaf(const std::vector<int>& colors) {
+        std::vector<int> labeling(num_vertices_);
+        for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+            labeling[colors[vertex]] = vertex;
+        }
+
+        std::vector<uint64_t> certificate(num_vertices_, 0);
+        for (int position = 0; position < num_vertices_; ++position) {
+            for (int neighbor = 0; neighbor < num_vertices_; ++neighbor) {
+                if (out_[labeling[position]] & Bit(neighbor)) {
+                    certificate[position] |= Bit(colors[neighbor]);
+                }
+            }
+        }
+
+        if (certificate_.empty() || certificate < certificate_) {
+            certificate_ = certificate;
+            labeling_ = labeling;
+        } else if (certificate == certificate_) {
+            std::vector<int> automorphism(num_vertices_);
+            for (int position = 0; position < num_vertices_; ++position) {
+                automorphism[labeling_[position]] = labeling[position];
+            }
+            automorphisms_.push_back(automorphism);
+        }
+    }
+};
+}  // namespace
+
+MultitreeGenerator::MultitreeGenerator(int num_vertices, int num_threads)
+    : num_vertices_(num_vertices),
+      num_threads_(num_threads),
+      split_level_(num_vertices - 3) {
+    if (num_vertices <= 0 || num_vertices > kMaxVertices) {
+        throw std::invalid_argument("Number of vertices must be 1 to 64.");
+    }
+
+    if (num_threads <= 0) {
+        throw std::invalid_argument(
+            "Number of threads must be greater than 0.");
+    }
+}
+
+long long MultitreeGenerator::Generate(const Visitor& visitor) const {
+    Multitree root = {};
+    root.num_vertices = 1;
+    root.descendants[0] = Bit(0);
+    root.ancestors[0] = Bit(0);
+
+    // Levels below 2 have a single node, so there is nothing to partition.
+    int num_workers = split_level_ >= 2 ? num_threads_ : 1;
+    std::vector<long long> num_generated(num_workers, 0);
+
+    auto worker = [&](int thread_index) {
+        long long split_counter = 0;
+        GenerateFromNode(root, visitor, thread_index, num_workers,
+                         split_counter, num_generated[thread_index]);
+    };
+
+    std::vector<std::thread> threads;
+    for (int thread_index = 1; thread_index < num_workers; ++thread_index) {
+        threads.push_back(std::thread(worker, thread_index));
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    long long total = 0;
+    for (auto& count : num_generated) {
+        total += count;
+    }
+    return total;
+}
+
+void MultitreeGenerator::GenerateFromNode(const Multitree& multitree,
+                                          const Visitor& visitor,
+                                          int thread_index, int num_workers,
+                                          long long& split_counter,
+                                          long long& num_generated) const {
+    if (multitree.num_vertices == split_level_ && num_workers > 1) {
+        if (split_counter++ % num_workers != thread_index) {
+            return;
+        }
+    }
+
+    if (multitree.num_vertices == num_vertices_) {
+        visitor(Edges(multitree), thread_index);
+        ++num_generated;
+        return;
+    }
+
+    std::array<uint64_t, kMaxVertices> ancestors_descendants = {};
+    for (int vertex = 0; vertex < multitree.num_vertices; ++vertex) {
+        for (int ancestor = 0; ancestor < multitree.num_vertices; ++ancestor) {
+            if (multitree.ancestors[vertex] & Bit(ancestor)) {
+                ancestors_descendants[vertex] |=
+                    multitree.descendants[ancestor];
+            }
+        }
+    }
+
+    std::vector<Multitree> children;
+    std::set<Certificate> child_certificates;
+    Augment(multitree, ancestors_descendants, 0, 0, 0, 0, 0, 0, children,
+            child_certificates);
+
+    for (auto& child : children) {
+        GenerateFromNode(child, visitor, thread_index, num_workers,
+                         split_counter, num_generated);
+    }
+}
+
+/* The new vertex v keeps the graph a multitree if and only if
+ *   - the ancestors of its in-neighbors are pairwise disjoint,
+ *   - the descendants of its out-neighbors are pairwise disjoint, and
+ *   - no ancestor of an in-neighbor reaches a descendant of an out-neighbor,
+ * since these are exactly the pairs that would get a second path through v.
+ */
+void MultitreeGenerator::Augment(
+    const Multitree& multitree,
+    const std::array<uint64_t, kMaxVertices>& ancestors_descendants,
+    int vertex, uint64_t in_set, uint64_t out_set, uint64_t in_ancestors,
+    uint64_t in_ancestors_descendants, uint64_t out_descendants,
+    std::vector<Multitree>& children,
+    std::set<Certificate>& child_certificates) const {
+    if (vertex == multitree.num_vertices) {
+        if ((in_set | out_set) == 0) {
+            return;
+        }
+
+        Multitree child = AddVertex(multitree, in_set, out_set);
+        Certificate certificate;
+        if (IsCanonicalAugmentation(child, certificate) &&
+            child_certificates.insert(certificate).second) {
+            children.push_back(child);
+        }
+        return;
+    }
+
+    Augment(multitree, ancestors_descendants, vertex + 1, in_set, out_set,
+            in_ancestors, in_ancestors_descendants, out_descendants, children,
+            child_certificates);
+
+    if ((multitree.ancestors[vertex] & in_ancestors) == 0 &&
+        (ancestors_descendants[vertex] & out_descendants) == 0) {
+        Augment(multitree, ancestors_descendants, vertex + 1,
+                in_set | Bit(vertex), out_set,
+                in_ancestors | multitree.ancestors[vertex],
+                in_ancestors_descendants | ancestors_descendants[vertex],
+                out_descendants, children, child_certificates);
+    }
+
+    if ((multitree.descendants[vertex] & out_descendants) == 0 &&
+        (multitree.descendants[vertex] & in_ancestors_descendants) == 0) {
+        Augment(multitree, ancestors_descendants, vertex + 1, in_set,
+                out_set | Bit(vertex), in_ancestors, in_ancestors_descendants,
+                out_descendants | multitree.descendants[vertex], children,
+                child_certificates);
+    }
+}
+
+/* The canonically deleted vertex is, among the non-cut vertices of minimum
+ * (degree, indegree), the one with the largest canonical position. */
+bool MultitreeGenerator::IsCanonicalAugmentation(
+    const Multitree& child, Certificate& certificate) const {
+    int num_vertices = child.num_vertices;
+    int new_vertex = num_vertices - 1;
+    std::vector<bool> non_cut_vertices = NonCutVertices(child);
+
+    auto key = [&child](int vertex) {
+        return std::make_pair(PopCount(child.out[vertex] | child.in[vertex]),
+                              PopCount(child.in[vertex]));
+    };
+
+    std::vector<int> candidates;
+    for (int vertex = 0; vertex < num_vertices; ++vertex) {
+        if (!non_cut_vertices[vertex]) {
+            continue;
+        }
+        if (!candidates.empty() && key(vertex) < key(candidates[0])) {
+            candidates.clear();
+        }
+        if (candidates.empty() || key(vertex) == key(candidates[0])) {
+            candidates.push_back(vertex);
+        }
+    }
+
+    if (std::find(candidates.begin(), candidates.end(), new_vertex) ==
+        candidates.end()) {
+        return false;
+    }
+
+    CanonicalLabeling labeling(num_vertices, child.out.data(), child.in.data(),
+                               std::vector<int>(num_vertices, 0));
+    certificate = labeling.Certificate();
+    if (candidates.size() == 1) {
+        return true;
+    }
+
+    int deleted_vertex = -1;
+    for (auto& vertex : labeling.Labeling()) {
+        if (std::find(candidates.begin(), candidates.end(), vertex) !=
+            candidates.end()) {
+            deleted_vertex = vertex;
+        }
+    }
+    if (deleted_vertex == new_vertex) {
+        return true;
+    }
+
+    // The new vertex and the deleted vertex are in the same orbit if and
+    // only if individualizing either of them gives the same certificate.
+    std::vector<int> colors(num_vertices, 0);
+    colors[new_vertex] = 1;
+    CanonicalLabeling new_vertex_labeling(num_vertices, child.out.data(),
+                                          child.in.data(), colors);
+    colors[new_vertex] = 0;
+    colors[deleted_vertex] = 1;
+    CanonicalLabeling deleted_vertex_labeling(
+        num_vertices, child.out.data(), child.in.data(), colors);
+
+    return new_vertex_labeling.Certificate() ==
+           deleted_vertex_labeling.Certificate();
+}
+
+MultitreeGenerator::Multitree MultitreeGenerator::AddVertex(
+    const Multitree& multitree, uint64_t in_set, uint64_t out_set) {
+    Multitree child = multitree;
+    int new_vertex = multitree.num_vertices;
+    child.num_vertices = new_vertex + 1;
+    child.out[new_vertex] = out_set;
+    child.in[new_vertex] = in_set;
+
+    uint64_t in_ancestors = 0;
+    uint64_t out_descendants = 0;
+    for (int vertex = 0; vertex < new_vertex; ++vertex) {
+        if (in_set & Bit(vertex)) {
+            child.out[vertex] |= Bit(new_vertex);
+            in_ancestors |= multitree.ancestors[vertex];
+        }
+        if (out_set & Bit(vertex)) {
+            child.in[vertex] |= Bit(new_vertex);
+            out_descendants |= multitree.descendants[vertex];
+        }
+    }
+
+    for (int vertex = 0; vertex < new_vertex; ++vertex) {
+        if (in_ancestors & Bit(vertex)) {
+            child.descendants[vertex] |= Bit(new_vertex) | out_descendants;
+        }
+        if (out_descendants & Bit(vertex)) {
+            child.ancestors[vertex] |= Bit(new_vertex) | in_ancestors;
+        }
+    }
+    child.descendants[new_vertex] = Bit(new_vertex) | out_descendants;
+    child.ancestors[new_vertex] = Bit(new_vertex) | in_ancestors;
+
+    return child;
+}
+
+std::vector<bool> MultitreeGenerator::NonCutVertices(
+    const Multitree& multitree) {
+    int num_vertices = multitree.num_vertices;
+    std::vector<bool> non_cut_vertices(num_vertices, true);
+    if (num_vertices <= 2) {
+        return non_cut_vertices;
+    }
+
+    uint64_t all_vertices = num_vertices == kMaxVertices
+                                ? ~uint64_t(0)
+                                : Bit(num_vertices) - 1;
+
+    for (int removed = 0; removed < num_vertices; ++removed) {
+        int start = removed == 0 ? 1 : 0;
+        uint64_t visited = Bit(start);
+        uint64_t frontier = Bit(start);
+        while (frontier != 0) {
+            uint64_t next_frontier = 0;
+            for (int vertex = 0; vertex < num_vertices; ++vertex) {
+                if (frontier & Bit(vertex)) {
+                    next_frontier |=
+                        multitree.out[vertex] | multitree.in[vertex];
+                }
+            }
+            next_frontier &= ~visited & ~Bit(removed);
+            visited |= next_frontier;
+            frontier = next_frontier;
+        }
+        non_cut_vertices[removed] = visited == (all_vertices & ~Bit(removed));
+    }
+
+    return non_cut_vertices;
+}
+
+std::vector<std::pair<int, int>> MultitreeGenerator::Edges(
+    const Multitree& multitree) {
+    std::vector<std::pair<int, int>> edges;
+    for (int vertex = 0; vertex < multitree.num_vertices; ++vertex) {
+        for (int neighbor = 0; neighbor < multitree.num_vertices; ++neighbor) {
+            if (multitree.out[vertex] & Bit(neighbor)) {
+                edges.push_back({vertex, neighbor});
+            }
+        }
+    }
+    return edges;
+}
+}  // namespace FTMR
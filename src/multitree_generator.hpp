@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace FTMR {
+
+// Enumerates the weakly connected multitrees with a given number of vertices,
+// one per isomorphism class, by canonical augmentation (McKay's method).
+//
+// Every multitree on k + 1 vertices is obtained from its canonical parent,
+// the multitree on k vertices left after deleting the canonically chosen
+// non-cut vertex. A new vertex is only attached with in- and out-neighbor sets
+// that keep the graph a multitree, so non-multitrees are pruned during the
+// search instead of being generated and filtered.
+class MultitreeGenerator {
+   public:
+    // Called with the edges of each generated multitree and the index of the
+    // worker thread that produced it. It may be called concurrently.
+    using Visitor = std::function<void(
+        const std::vector<std::pair<int, int>>& edges, int thread_index)>;
+
+    static constexpr int kMaxVertices = 64;
+
+    MultitreeGenerator(int num_vertices, int num_threads);
+
+    ~MultitreeGenerator() = default;
+
+    // Generates all multitrees and passes them to visitor. The search tree is
+    // partitioned among the worker threads at a fixed level: every thread
+    // walks the levels above it and only expands its own share of the nodes
+    // there. Returns the number of generated multitrees.
+    long long Generate(const Visitor& visitor) const;
+
+   private:
+    struct Multitree {
+        int num_vertices;
+        // Bit masks of out-/in-neighbors, and of the vertices reachable
+        // from/to each vertex (both including the vertex itself).
+        std::array<uint64_t, kMaxVertices> out;
+        std::array<uint64_t, kMaxVertices> in;
+        std::array<uint64_t, kMaxVertices> descendants;
+        std::array<uint64_t, kMaxVertices> ancestors;
+    };
+
+    using Certificate = std::vector<uint64_t>;
+
+    int num_vertices_;
+    int num_threads_;
+    int split_level_;
+
+    void GenerateFromNode(const Multitree& multitree, const Visitor& visitor,
+                          int thread_index, int num_workers,
+                          long long& split_counter,
+                          long long& num_generated) const;
+
+    // Tries all in-/out-neighbor sets of a new vertex, deciding the vertices
+    // from vertex onwards. ancestors_descendants[v] holds every vertex
+    // reachable from an ancestor of v.
+    void Augment(
+        const Multitree& multitree,
+        const std::array<uint64_t, kMaxVertices>& ancestors_descendants,
+        int vertex, uint64_t in_set, uint64_t out_set, uint64_t in_ancestors,
+        uint64_t in_ancestors_descendants, uint64_t out_descendants,
+        std::vector<Multitree>& children,
+        std::set<Certificate>& child_certificates) const;
+
+    // Returns true when the last vertex of child lies in the orbit of the
+    // canonically deleted vertex, and stores the certificate of child.
+    bool IsCanonicalAugmentation(const Multitree& child,
+                                 Certificate& certificate) const;
+
+    static Multitree AddVertex(const Multitree& multitree, uint64_t in_set,
+                               uint64_t out_set);
+
+    static std::vector<bool> NonCutVertices(const Multitree& multitree);
+
+    static std::vector<std::pair<int, int>> Edges(const Multitree& multitree);
+};
+
+}  // namespace FTMR
@@ -1,13 +1,66 @@
 #include "multitree_recolorability.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <utility>
 
 namespace FTMR {
+namespace {
+// Rows of bits over the path numbers, stored in one array.
+class PathSets {
+   public:
+    PathSets(int num_sets, int num_paths)
+        : num_words_((num_paths + 63) / 64),
+          words_(num_sets * num_words_, 0) {}
+
+    void Set(int set_index, int path_number) {
+        words_[set_index * num_words_ + path_number / 64] |=
+            uint64_t(1) << (path_number % 64);
+    }
+
+    bool Test(int set_index, int path_number) const {
+        return (words_[set_index * num_words_ + path_number / 64] >>
+                (path_number % 64)) &
+               1;
+    }
+
+    const uint64_t *Row(int set_index) const {
+        return &words_[set_index * num_words_];
+    }
+
+    // Returns true if some path is in row set_index and in set, but not in
+    // excluded.
+    bool IntersectsExcept(int set_index, const uint64_t *set,
+                          const uint64_t *excluded) const {
+        const uint64_t *row = Row(set_index);
+        for (int i = 0; i < num_words_; ++i) {
+            if (row[i] & set[i] & ~excluded[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+   private:
+    int num_words_;
+    std::vector<uint64_t> words_;
+};
+
+template <typename Check>
+CheckResult RunWithBudget(const Check &check) {
+    try {
+        return check() ? CheckResult::kSatisfied : CheckResult::kNotSatisfied;
+    } catch (const DeadlineExceeded &) {
+        return CheckResult::kUnknown;
+    }
+}
+}  // namespace
+
 MultitreeRecolorability::MultitreeRecolorability(const DirectedGraph &digraph)
     : multitree_(digraph), path_relation_graph_vertices_() {
     unilaterally_connected_components_ =
         multitree_.UnilaterallyConnectedComponents();
-    ConstructPathRelationGraph();
+    ConstructPathRelationGraph(nullptr);
 }
 
 MultitreeRecolorability::MultitreeRecolorability(
@@ -15,10 +68,136 @@ MultitreeRecolorability::MultitreeRecolorability(
     : multitree_(edges, num_vertices), path_relation_graph_vertices_() {
     unilaterally_connected_components_ =
         multitree_.UnilaterallyConnectedComponents();
-    ConstructPathRelationGraph();
+    ConstructPathRelationGraph(nullptr);
+}
+
+MultitreeRecolorability::MultitreeRecolorability(
+    const std::vector<std::pair<int, int>> &edges, int num_vertices,
+    Budget &budget)
+    : multitree_(edges, num_vertices), path_relation_graph_vertices_() {
+    unilaterally_connected_components_ =
+        multitree_.UnilaterallyConnectedComponents(budget);
+    ConstructPathRelationGraph(&budget);
+}
+
+MultitreeRecolorability::MultitreeRecolorability(const DirectedGraph &digraph,
+                                                 VertexOrder order)
+    : path_relation_graph_vertices_() {
+    RelabeledGraph relabeled = digraph.Reorder(order);
+    multitree_ = std::move(relabeled.graph);
+    new_number_ = std::move(relabeled.new_number);
+    original_number_ = std::move(relabeled.original_number);
+    unilaterally_connected_components_ =
+        multitree_.UnilaterallyConnectedComponents();
+    ConstructPathRelationGraph(nullptr);
+}
+
+/* In a polytree the unilaterally connected components are the maximal
+ * directed paths, from a vertex without in-edges to one without out-edges. */
+MultitreeRecolorability::MultitreeRecolorability(
+    const PolytreeSkeleton &skeleton, uint64_t flip_bits)
+    : skeleton_(&skeleton),
+      flip_bits_(flip_bits),
+      path_relation_graph_vertices_() {
+    int num_vertices = skeleton.NumVertices();
+    std::vector<std::pair<int, int>> edges(num_vertices - 1);
+    for (int i = 0; i < num_vertices - 1; ++i) {
+        edges[i] = skeleton.GetEdge(i, flip_bits);
+    }
+    multitree_ = DirectedGraph(edges, num_vertices);
+
+    std::vector<int> sources;
+    std::vector<int> sinks;
+    for (int vertex = 0; vertex < num_vertices; ++vertex) {
+        if (skeleton.InDegree(vertex, flip_bits) == 0) {
+            sources.push_back(vertex);
+        }
+        if (skeleton.OutDegree(vertex, flip_bits) == 0) {
+            sinks.push_back(vertex);
+        }
+    }
+    for (auto &source : sources) {
+        for (auto &sink : sinks) {
+            if (skeleton.Reaches(source, sink, flip_bits)) {
+                unilaterally_connected_components_.push_back(
+                    skeleton.Path(source, sink));
+            }
+        }
+    }
+    ConstructPathRelationGraphFromSkeleton();
+}
+
+/* The rows of the snapshot are copied into the adjacency lists, in the same
+ * order as when the snapshot was written. */
+MultitreeRecolorability::MultitreeRecolorability(
+    const MultitreeSnapshot &snapshot)
+    : multitree_(), path_relation_graph_vertices_() {
+    const CompressedRows &multitree = snapshot.Multitree();
+    std::vector<std::pair<int, int>> edges;
+    for (int vertex = 0; vertex < multitree.num_rows; ++vertex) {
+        for (auto itr = multitree.RowBegin(vertex);
+             itr != multitree.RowEnd(vertex); ++itr) {
+            edges.push_back({vertex, static_cast<int>(*itr)});
+        }
+    }
+    multitree_ = DirectedGraph(edges, multitree.num_rows);
+
+    const CompressedRows &components =
+        snapshot.UnilaterallyConnectedComponents();
+    unilaterally_connected_components_.resize(components.num_rows);
+    for (int i = 0; i < components.num_rows; ++i) {
+        unilaterally_connected_components_[i].assign(components.RowBegin(i),
+                                                     components.RowEnd(i));
+    }
+
+    const CompressedRows &path_relation_graph = snapshot.PathRelationGraph();
+    path_relation_graph_vertices_.resize(path_relation_graph.num_rows);
+    edges.clear();
+    for (int path_number = 0; path_number < path_relation_graph.num_rows;
+         ++path_number) {
+        path_relation_graph_vertices_[path_number] =
+            snapshot.GetPath(path_number);
+        for (auto itr = path_relation_graph.RowBegin(path_number);
+             itr != path_relation_graph.RowEnd(path_number); ++itr) {
+            edges.push_back({path_number, static_cast<int>(*itr)});
+        }
+    }
+    path_relation_graph_ =
+        DirectedGraph(edges, path_relation_graph_vertices_.size());
+}
+
+/* A relabeled state is translated back to the input numbers. The path
+ * numbers, and so the path relation graph, do not change. */
+void MultitreeRecolorability::WriteSnapshot(const std::string &filename) const {
+    if (original_number_.empty()) {
+        WriteMultitreeSnapshot(filename, multitree_,
+                               unilaterally_connected_components_,
+                               path_relation_graph_vertices_,
+                               path_relation_graph_);
+        return;
+    }
+
+    std::vector<std::vector<int>> components(
+        unilaterally_connected_components_);
+    for (auto &component : components) {
+        for (auto &vertex : component) {
+            vertex = original_number_[vertex];
+        }
+    }
+    std::vector<std::pair<int, int>> paths(path_relation_graph_vertices_);
+    for (auto &path : paths) {
+        path = {original_number_[path.first], original_number_[path.second]};
+    }
+    WriteMultitreeSnapshot(filename, multitree_.Relabel(original_number_),
+                           components, paths, path_relation_graph_);
 }
 
 int MultitreeRecolorability::GetPathNumber(std::pair<int, int> path) {
+    if (skeleton_ != nullptr) {
+        return path_numbers_[path.first * skeleton_->NumVertices() +
+                             path.second];
+    }
+
     auto itr = std::find(path_relation_graph_vertices_.begin(),
                          path_relation_graph_vertices_.end(), path);
     if (itr != path_relation_graph_vertices_.end()) {
@@ -28,6 +207,27 @@ int MultitreeRecolorability::GetPathNumber(std::pair<int, int> path) {
 }
 
 bool MultitreeRecolorability::IsReachable(int vertex_start, int vertex_end) {
+    if (!new_number_.empty()) {
+        if (vertex_start < 0 || vertex_start >= new_number_.size() ||
+            vertex_end < 0 || vertex_end >= new_number_.size()) {
+            return false;
+        }
+        vertex_start = new_number_[vertex_start];
+        vertex_end = new_number_[vertex_end];
+    }
+    return IsReachableInMultitree(vertex_start, vertex_end);
+}
+
+bool MultitreeRecolorability::IsReachableInMultitree(int vertex_start,
+                                                     int vertex_end) {
+    if (skeleton_ != nullptr) {
+        int num_vertices = skeleton_->NumVertices();
+        return vertex_start >= 0 && vertex_start < num_vertices &&
+               vertex_end >= 0 && vertex_end < num_vertices &&
+               vertex_start != vertex_end &&
+               skeleton_->Reaches(vertex_start, vertex_end, flip_bits_);
+    }
+
     if (unilaterally_connected_components_.size() == 0) {
         unilaterally_connected_components_ =
             multitree_.UnilaterallyConnectedComponents();
@@ -44,7 +244,70 @@ bool MultitreeRecolorability::IsReachable(int vertex_start, int vertex_end) {
 }
 
 bool MultitreeRecolorability::CheckConditionS() {
+    return EvaluateConditionS(nullptr);
+}
+
+bool MultitreeRecolorability::CheckConditionCycle() {
+    return EvaluateConditionCycle(nullptr);
+}
+
+bool MultitreeRecolorability::CheckConditionCP() {
+    return EvaluateConditionCP(nullptr);
+}
+
+bool MultitreeRecolorability::CheckConditionCPBitParallel() {
+    return EvaluateConditionCPBitParallel(nullptr);
+}
+
+bool MultitreeRecolorability::CheckConditionCV() {
+    return EvaluateConditionCV(1, nullptr);
+}
+
+bool MultitreeRecolorability::CheckConditionCV(int num_threads) {
+    return EvaluateConditionCV(num_threads, nullptr);
+}
+
+bool MultitreeRecolorability::CheckConditionCVPolynomial() {
+    return EvaluateConditionCVPolynomial(nullptr);
+}
+
+CheckResult MultitreeRecolorability::CheckConditionS(Budget &budget) {
+    return RunWithBudget([&]() { return EvaluateConditionS(&budget); });
+}
+
+CheckResult MultitreeRecolorability::CheckConditionCycle(Budget &budget) {
+    return RunWithBudget([&]() { return EvaluateConditionCycle(&budget); });
+}
+
+CheckResult MultitreeRecolorability::CheckConditionCP(Budget &budget) {
+    return RunWithBudget([&]() { return EvaluateConditionCP(&budget); });
+}
+
+CheckResult MultitreeRecolorability::CheckConditionCPBitParallel(
+    Budget &budget) {
+    return RunWithBudget(
+        [&]() { return EvaluateConditionCPBitParallel(&budget); });
+}
+
+CheckResult MultitreeRecolorability::CheckConditionCV(Budget &budget) {
+    return RunWithBudget([&]() { return EvaluateConditionCV(1, &budget); });
+}
+
+CheckResult MultitreeRecolorability::CheckConditionCV(int num_threads,
+                                                      Budget &budget) {
+    return RunWithBudget(
+        [&]() { return EvaluateConditionCV(num_threads, &budget); });
+}
+
+CheckResult MultitreeRecolorability::CheckConditionCVPolynomial(
+    Budget &budget) {
+    return RunWithBudget(
+        [&]() { return EvaluateConditionCVPolynomial(&budget); });
+}
+
+bool MultitreeRecolorability::EvaluateConditionS(Budget *budget) {
     for (const auto &component : unilaterally_connected_components_) {
+        CheckBudget(budget);
         std::vector<int> merging_vertex_order;
         std::vector<int> splitting_vertex_order;
         int number = 0;
@@ -73,12 +336,13 @@ bool MultitreeRecolorability::CheckConditionS() {
     return true;
 }
 
-bool MultitreeRecolorability::CheckConditionCycle() {
+bool MultitreeRecolorability::EvaluateConditionCycle(Budget *budget) {
     const std::vector<std::pair<int, int>> edges_of_prg =
         path_relation_graph_.Edges();
 
     std::vector<std::pair<int, int>> edges;
     for (auto &edge : edges_of_prg) {
+        CheckBudget(budget);
         if (std::find(edges_of_prg.begin(), edges_of_prg.end(),
                       std::pair<int, int>(edge.second, edge.first)) ==
             edges_of_prg.end()) {
@@ -98,17 +362,16 @@ int MultitreeRecolorability::GetNextStepPathNumber(int path_number) {
     }
 
     for (auto &adjacent_vertex : multitree_.AdjacentVertices(path.first)) {
-        auto itr = std::find(path_relation_graph_vertices_.begin(),
-                             path_relation_graph_vertices_.end(),
-                             std::pair<int, int>(adjacent_vertex, path.second));
-        if (itr != path_relation_graph_vertices_.end()) {
-            return std::distance(path_relation_graph_vertices_.begin(), itr);
+        int next_step_path_number =
+            GetPathNumber(std::pair<int, int>(adjacent_vertex, path.second));
+        if (next_step_path_number != -1) {
+            return next_step_path_number;
         }
     }
     return path_number;
 }
 
-bool MultitreeRecolorability::CheckConditionCP() {
+bool MultitreeRecolorability::EvaluateConditionCP(Budget *budget) {
     DirectedGraph path_relation_without_cycles =
         path_relation_graph_.DeleteCyclesOfLength2();
     std::vector<std::vector<int>> strongly_connected_components =
@@ -116,6 +379,7 @@ bool MultitreeRecolorability::CheckConditionCP() {
 
     for (const auto &component : strongly_connected_components) {
         for (auto &path_number : component) {
+            CheckBudget(budget);
             bool condition_cp_on_path =
                 CheckConditionCPOnPath(path_number, component);
             if (!condition_cp_on_path) {
@@ -127,6 +391,107 @@ bool MultitreeRecolorability::CheckConditionCP() {
     return true;
 }
 
+bool MultitreeRecolorability::EvaluateConditionCPBitParallel(Budget *budget) {
+    int num_paths = path_relation_graph_.NumVertices();
+    int num_vertices = multitree_.NumVertices();
+
+    std::vector<std::vector<int>> adjacency_list(num_paths);
+    PathSets adjacent_paths(num_paths, num_paths);
+    PathSets reverse_adjacent_paths(num_paths, num_paths);
+    std::vector<int> path_numbers(num_vertices * num_vertices, -1);
+    for (int path_number = 0; path_number < num_paths; ++path_number) {
+        adjacency_list[path_number] =
+            path_relation_graph_.AdjacentVertices(path_number);
+        for (auto &adjacent_path_number : adjacency_list[path_number]) {
+            adjacent_paths.Set(path_number, adjacent_path_number);
+            reverse_adjacent_paths.Set(adjacent_path_number, path_number);
+        }
+        std::pair<int, int> path = GetPath(path_number);
+        path_numbers[path.first * num_vertices + path.second] = path_number;
+    }
+
+    // Strongly connected components of the PRG without cycles of length 2.
+    std::vector<std::pair<int, int>> edges;
+    for (int path_number = 0; path_number < num_paths; ++path_number) {
+        for (auto &adjacent_path_number : adjacency_list[path_number]) {
+            if (!adjacent_paths.Test(adjacent_path_number, path_number)) {
+                edges.push_back({path_number, adjacent_path_number});
+            }
+        }
+    }
+    std::vector<std::vector<int>> strongly_connected_components =
+        DirectedGraph(edges, num_paths).StronglyConnectedComponents();
+
+    // is_reachable[u][v] is true when v comes after u in one of the
+    // unilaterally connected components, each of which is a directed path.
+    std::vector<std::vector<bool>> is_reachable(
+        num_vertices, std::vector<bool>(num_vertices, false));
+    for (auto &component : unilaterally_connected_components_) {
+        for (int i = 0; i < component.size(); ++i) {
+            for (int j = i + 1; j < component.size(); ++j) {
+                is_reachable[component[i]][component[j]] = true;
+            }
+        }
+    }
+    // Row x of reachable_ends holds the paths whose last vertex is reachable
+    // from x. Rows are filled when first needed.
+    PathSets reachable_ends(num_vertices, num_paths);
+    std::vector<bool> has_reachable_ends(num_vertices, false);
+
+    PathSets members(1, num_paths);
+    for (const auto &component : strongly_connected_components) {
+        // A path has no neighbor in its own single-path component.
+        if (component.size() == 1) {
+            continue;
+        }
+
+        members = PathSets(1, num_paths);
+        for (auto &path_number : component) {
+            members.Set(0, path_number);
+        }
+
+        for (auto &path_number : component) {
+            CheckBudget(budget);
+
+            // Same next step as GetNextStepPathNumber.
+            std::pair<int, int> path = GetPath(path_number);
+            int next_step_path_number = path_number;
+            if (path.first != path.second) {
+                for (auto &adjacent_vertex :
+                     multitree_.AdjacentVertices(path.first)) {
+                    int number = path_numbers[adjacent_vertex * num_vertices +
+                                              path.second];
+                    if (number != -1) {
+                        next_step_path_number = number;
+                        break;
+                    }
+                }
+            }
+
+            int next_step_first = GetPath(next_step_path_number).first;
+            if (!has_reachable_ends[next_step_first]) {
+                for (int end = 0; end < num_paths; ++end) {
+                    if (is_reachable[next_step_first][GetPath(end).second]) {
+                        reachable_ends.Set(next_step_first, end);
+                    }
+                }
+                has_reachable_ends[next_step_first] = true;
+            }
+
+            if (adjacent_paths.IntersectsExcept(
+                    path_number, members.Row(0),
+                    reverse_adjacent_paths.Row(next_step_path_number)) &&
+                reverse_adjacent_paths.IntersectsExcept(
+                    path_number, members.Row(0),
+                    reachable_ends.Row(next_step_first))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 /* Check (CP) for the path with "path_number" */
 bool MultitreeRecolorability::CheckConditionCPOnPath(
     int path_number, const std::vector<int> &component) {
@@ -151,8 +516,8 @@ bool MultitreeRecolorability::CheckConditionCPOnPath(
                 adjacent_path_number, next_step_path_number);
 
             bool cycle_persist =
-                IsReachable(GetPath(next_step_path_number).first,
-                            GetPath(radjacent_path_number).second);
+                IsReachableInMultitree(GetPath(next_step_path_number).first,
+                                       GetPath(radjacent_path_number).second);
 
             if (!cycle2_appear && !cycle_persist) {
                 return false;
@@ -163,20 +528,47 @@ bool MultitreeRecolorability::CheckConditionCPOnPath(
     return true;
 }
 
-bool MultitreeRecolorability::CheckConditionCV() {
+/* The visitor stops the cycle search at the first cycle violating (CV). */
+bool MultitreeRecolorability::EvaluateConditionCV(int num_threads,
+                                                  Budget *budget) {
+    CheckBudget(budget);
+    DirectedGraph path_relation_without_cycles =
+        path_relation_graph_.DeleteCyclesOfLength2();
+    DirectedGraph::CycleVisitor visitor =
+        [this](const std::vector<int> &path_cycle) {
+            return CheckConditionCVOnPathCycle(path_cycle);
+        };
+
+    if (budget == nullptr) {
+        return path_relation_without_cycles.VisitSimpleCycles(visitor,
+                                                              num_threads);
+    }
+    return path_relation_without_cycles.VisitSimpleCycles(visitor, num_threads,
+                                                          *budget);
+}
+
+bool MultitreeRecolorability::EvaluateConditionCVPolynomial(Budget *budget) {
     DirectedGraph path_relation_without_cycles =
         path_relation_graph_.DeleteCyclesOfLength2();
-    std::vector<std::vector<int>> simple_path_cycles =
-        path_relation_without_cycles.SimpleCycles();
 
-    for (auto &path_cycle : simple_path_cycles) {
-        bool condition_cv_on_path_cycle =
-            CheckConditionCVOnPathCycle(path_cycle);
-        if (!condition_cv_on_path_cycle) {
-            return false;
+    std::vector<std::pair<int, int>> compliant_edges;
+    for (int path_number = 0;
+         path_number < path_relation_without_cycles.NumVertices();
+         ++path_number) {
+        CheckBudget(budget);
+        int next_step_path_number = GetNextStepPathNumber(path_number);
+        for (auto &adjacent_path_number :
+             path_relation_without_cycles.AdjacentVertices(path_number)) {
+            if (path_relation_graph_.IsAdjacent(adjacent_path_number,
+                                                next_step_path_number)) {
+                compliant_edges.push_back({path_number, adjacent_path_number});
+            }
         }
     }
-    return true;
+
+    DirectedGraph compliant_graph(compliant_edges,
+                                  path_relation_without_cycles.NumVertices());
+    return compliant_graph.IsDAG();
 }
 
 /* Check (CP) for a cycle */
@@ -197,7 +589,7 @@ bool MultitreeRecolorability::CheckConditionCVOnPathCycle(
     return false;
 }
 
-void MultitreeRecolorability::ConstructPathRelationGraph() {
+void MultitreeRecolorability::ConstructPathRelationGraph(Budget *budget) {
     std::vector<std::vector<int>> path_list;
     for (auto &component : unilaterally_connected_components_) {
         for (int i = 0; i < component.size(); ++i) {
@@ -217,6 +609,7 @@ void MultitreeRecolorability::ConstructPathRelationGraph() {
     std::vector<std::pair<int, int>> edges;
     int vertex1_index = 0;
     for (const auto &prg_vertex1 : path_relation_graph_vertices_) {
+        CheckBudget(budget);
         int vertex2_index = 0;
         for (const auto &prg_vertex2 : path_relation_graph_vertices_) {
             if (prg_vertex1 == prg_vertex2) {
@@ -246,4 +639,45 @@ void MultitreeRecolorability::ConstructPathRelationGraph() {
     path_relation_graph_ =
         DirectedGraph(edges, path_relation_graph_vertices_.size());
 }
-}  // namespace FTMR
\ No newline at end of file
+
+/* x is on the path (a, b) iff a reaches x and x reaches b, because paths in
+ * a polytree are unique. */
+void MultitreeRecolorability::ConstructPathRelationGraphFromSkeleton() {
+    int num_vertices = skeleton_->NumVertices();
+    path_numbers_.assign(num_vertices * num_vertices, -1);
+    for (auto &component : unilaterally_connected_components_) {
+        for (int i = 0; i < component.size(); ++i) {
+            for (int j = i; j < component.size(); ++j) {
+                int &path_number =
+                    path_numbers_[component[i] * num_vertices + component[j]];
+                if (path_number == -1) {
+                    path_number = path_relation_graph_vertices_.size();
+                    path_relation_graph_vertices_.push_back(
+                        {component[i], component[j]});
+                }
+            }
+        }
+    }
+
+    auto is_on_path = [this](int vertex, const std::pair<int, int> &path) {
+        return skeleton_->Reaches(path.first, vertex, flip_bits_) &&
+               skeleton_->Reaches(vertex, path.second, flip_bits_);
+    };
+
+    std::vector<std::pair<int, int>> edges;
+    int num_paths = path_relation_graph_vertices_.size();
+    for (int path_number1 = 0; path_number1 < num_paths; ++path_number1) {
+        const auto &path1 = path_relation_graph_vertices_[path_number1];
+        for (int path_number2 = 0; path_number2 < num_paths; ++path_number2) {
+            const auto &path2 = path_relation_graph_vertices_[path_number2];
+            if (path_number1 != path_number2 &&
+                (is_on_path(path2.first, path1) ||
+                 is_on_path(path1.second, path2))) {
+                edges.push_back({path_number1, path_number2});
+            }
+        }
+    }
+
+    path_relation_graph_ = DirectedGraph(edges, num_paths);
+}
+}  // namespace FTMR
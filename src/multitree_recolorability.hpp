@@ -1,6 +1,9 @@
 #pragma once
 
+#include "budget.hpp"
 #include "directed_graph.hpp"
+#include "multitree_snapshot.hpp"
+#include "polytree_orientations.hpp"
 
 namespace FTMR {
 
@@ -15,6 +18,33 @@ class MultitreeRecolorability {
     MultitreeRecolorability(const std::vector<std::pair<int, int>>& edges,
                             int num_vertices);
 
+    // Throws DeadlineExceeded if the budget runs out while building the path
+    // relation graph.
+    MultitreeRecolorability(const std::vector<std::pair<int, int>>& edges,
+                            int num_vertices, Budget& budget);
+
+    // Runs the checks on the multitree renumbered in the given order, which
+    // keeps the searches over nearby vertices local in memory. IsReachable
+    // still takes the vertex numbers of digraph.
+    MultitreeRecolorability(const DirectedGraph& digraph, VertexOrder order);
+
+    // Orientation flip_bits of the skeleton's tree. The components, the
+    // paths and the reachability tests come from the skeleton instead of
+    // graph searches, so IsReachable takes O(1) time. The skeleton must
+    // outlive this object.
+    MultitreeRecolorability(const PolytreeSkeleton& skeleton,
+                            uint64_t flip_bits);
+
+    // Loads the state written by WriteSnapshot instead of computing the
+    // components and the path relation graph again. The rows are still
+    // copied into this object, in O(PRG edges) time and memory.
+    explicit MultitreeRecolorability(const MultitreeSnapshot& snapshot);
+
+    // Writes the multitree, its components, the paths and the path relation
+    // graph to a snapshot file, in the vertex numbers of the input. Throws
+    // std::runtime_error if the file cannot be written.
+    void WriteSnapshot(const std::string& filename) const;
+
     // Returns true if and only if vertex_end is reachable from vertex_start.
     bool IsReachable(int vertex_start, int vertex_end);
 
@@ -26,11 +56,57 @@ class MultitreeRecolorability {
 
     bool CheckConditionCP();
 
+    // Same result as CheckConditionCP. For each path p, the out-neighbors
+    // violating IsAdjacent(q, next(p)) and the in-neighbors violating
+    // IsReachable(next(p).first, r.second) within the component of p are
+    // computed as bitsets over the paths, and (CP) fails iff both are
+    // non-empty for some p.
+    bool CheckConditionCPBitParallel();
+
     bool CheckConditionCV();
 
+    // Same result as CheckConditionCV, enumerating the cycles on num_threads
+    // threads and stopping at the first cycle that violates (CV).
+    bool CheckConditionCV(int num_threads);
+
+    // Same result as CheckConditionCV, but without enumerating simple cycles.
+    // A simple cycle of the 2-cycle-free path relation graph violates (CV)
+    // only if every step p -> q on it satisfies IsAdjacent(q, next(p)), so
+    // (CV) holds iff the subgraph made of those compliant edges is a DAG.
+    bool CheckConditionCVPolynomial();
+
+    // Budgeted versions of the checks above. They return
+    // CheckResult::kUnknown if the budget runs out before the answer is
+    // known.
+    CheckResult CheckConditionS(Budget& budget);
+
+    CheckResult CheckConditionCycle(Budget& budget);
+
+    CheckResult CheckConditionCP(Budget& budget);
+
+    CheckResult CheckConditionCPBitParallel(Budget& budget);
+
+    CheckResult CheckConditionCV(Budget& budget);
+
+    CheckResult CheckConditionCV(int num_threads, Budget& budget);
+
+    CheckResult CheckConditionCVPolynomial(Budget& budget);
+
    private:
     DirectedGraph multitree_;
 
+    // Vertex numbers of multitree_ for the input vertices and back, or empty
+    // if multitree_ is numbered like the input.
+    std::vector<int> new_number_;
+    std::vector<int> original_number_;
+
+    // The polytree skeleton and orientation this was built from, or null.
+    // path_numbers_[first * n + last] is then the number of path (first,
+    // last), or -1.
+    const PolytreeSkeleton* skeleton_ = nullptr;
+    uint64_t flip_bits_ = 0;
+    std::vector<int> path_numbers_;
+
     std::vector<std::vector<int>> unilaterally_connected_components_;
 
     DirectedGraph path_relation_graph_;
@@ -41,9 +117,16 @@ class MultitreeRecolorability {
         return path_relation_graph_vertices_[path_number];
     }
 
+    // Returns the number of path, or -1. O(1) with a skeleton.
     int GetPathNumber(std::pair<int, int> path);
 
-    void ConstructPathRelationGraph();
+    // Same as IsReachable, but on the vertex numbers of multitree_.
+    bool IsReachableInMultitree(int vertex_start, int vertex_end);
+
+    void ConstructPathRelationGraph(Budget* budget);
+
+    // Same graph, testing whether a vertex is on a path with the skeleton.
+    void ConstructPathRelationGraphFromSkeleton();
 
     int GetNextStepPathNumber(int path_number);
 
@@ -51,6 +134,20 @@ class MultitreeRecolorability {
                                 const std::vector<int>& component);
 
     bool CheckConditionCVOnPathCycle(std::vector<int> path_cycle);
+
+    // Implementations of the checks. They throw DeadlineExceeded if budget
+    // is not null and runs out.
+    bool EvaluateConditionS(Budget* budget);
+
+    bool EvaluateConditionCycle(Budget* budget);
+
+    bool EvaluateConditionCP(Budget* budget);
+
+    bool EvaluateConditionCPBitParallel(Budget* budget);
+
+    bool EvaluateConditionCV(int num_threads, Budget* budget);
+
+    bool EvaluateConditionCVPolynomial(Budget* budget);
 };
 
 }  // namespace FTMR
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "multitree_snapshot.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace FTMR {
+namespace {
+constexpr char kMagic[8] = {'F', 'T', 'M', 'R', 'S', 'N', 'A', 'P'};
+
+struct MultitreeSnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_vertices;
+    uint64_t num_edges;
+    uint64_t num_components;
+    uint64_t num_component_vertices;
+    uint64_t num_paths;
+    uint64_t num_prg_edges;
+    uint64_t reserved;
+};
+
+uint64_t PaddedSize(uint64_t size) { return (size + 7) / 8 * 8; }
+
+// Writes the array followed by zeros up to a multiple of 8 bytes.
+template <typename T>
+void WriteArray(std::ofstream& file, const std::vector<T>& values) {
+    static const char kZeros[8] = {};
+    uint64_t size = values.size() * sizeof(T);
+    file.write(reinterpret_cast<const char*>(values.data()), size);
+    file.write(kZeros, PaddedSize(size) - size);
+}
+
+void WriteGraph(std::ofstream& file, const DirectedGraph& graph) {
+    std::vector<uint64_t> offsets = {0};
+    std::vector<uint32_t> targets;
+    targets.reserve(graph.NumEdges());
+    for (int vertex = 0; vertex < graph.NumVertices(); ++vertex) {
+        for (auto& target : graph.AdjacentVertices(vertex)) {
+            targets.push_back(target);
+        }
+        offsets.push_back(targets.size());
+    }
+    WriteArray(file, offsets);
+    WriteArray(file, targets);
+}
+
+// Consecutive padded arrays of a mapped snapshot.
+class ArrayReader {
+   public:
+    ArrayReader(const char* data, size_t size)
+        : data_(data), size_(size), position_(0) {}
+
+    // Returns the next array of count elements, or nullptr if the file is
+    // too short.
+    template <typename T>
+    const T* Next(uint64_t count) {
+        if (count > (size_ - position_) / sizeof(T) ||
+            PaddedSize(count * sizeof(T)) > size_ - position_) {
+            return nullptr;
+        }
+        const T* array = reinterpret_cast<const T*>(data_ + position_);
+        position_ += PaddedSize(count * sizeof(T));
+        return array;
+    }
+
+   private:
+    const char* data_;
+    size_t size_;
+    size_t position_;
+};
+
+// Checks that the offsets split num_values values into rows and that every
+// value is less than bound.
+bool IsValidRows(const CompressedRows& rows, uint64_t num_values,
+                 uint64_t bound) {
+    if (rows.offsets[0] != 0 || rows.offsets[rows.num_rows] != num_values) {
+        return false;
+    }
+    for (int row = 0; row < rows.num_rows; ++row) {
+        if (rows.offsets[row] > rows.offsets[row + 1]) {
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < num_values; ++i) {
+        if (rows.values[i] >= bound) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+void WriteMultitreeSnapshot(
+    const std::string& filename, const DirectedGraph& multitree,
+    const std::vector<std::vector<int>>& unilaterally_connected_components,
+    const std::vector<std::pair<int, int>>& paths,
+    const DirectedGraph& path_relation_graph) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open multitree snapshot for writing.");
+    }
+
+    std::vector<uint64_t> component_offsets = {0};
+    std::vector<uint32_t> component_vertices;
+    for (auto& component : unilaterally_connected_components) {
+        component_vertices.insert(component_vertices.end(), component.begin(),
+                                  component.end());
+        component_offsets.push_back(component_vertices.size());
+    }
+
+    std::vector<uint32_t> path_vertices;
+    path_vertices.reserve(2 * paths.size());
+    for (auto& path : paths) {
+        path_vertices.push_back(path.first);
+        path_vertices.push_back(path.second);
+    }
+
+    MultitreeSnapshotHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kMultitreeSnapshotVersion;
+    header.num_vertices = multitree.NumVertices();
+    header.num_edges = multitree.NumEdges();
+    header.num_components = unilaterally_connected_components.size();
+    header.num_component_vertices = component_vertices.size();
+    header.num_paths = paths.size();
+    header.num_prg_edges = path_relation_graph.NumEdges();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    WriteGraph(file, multitree);
+    WriteArray(file, component_offsets);
+    WriteArray(file, component_vertices);
+    WriteArray(file, path_vertices);
+    WriteGraph(file, path_relation_graph);
+    if (!file) {
+        throw std::runtime_error("Cannot write multitree snapshot.");
+    }
+}
+
+MultitreeSnapshot::MultitreeSnapshot(const std::string& filename)
+    : data_(nullptr),
+      size_(0),
+      multitree_(),
+      components_(),
+      paths_(nullptr),
+      path_relation_graph_() {
+    int file = open(filename.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::runtime_error("Cannot open multitree snapshot.");
+    }
+
+    struct stat file_status;
+    if (fstat(file, &file_status) != 0 ||
+        file_status.st_size < sizeof(MultitreeSnapshotHeader)) {
+        close(file);
+        throw std::runtime_error("Invalid multitree snapshot.");
+    }
+
+    size_ = file_status.st_size;
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error("Cannot map multitree snapshot.");
+    }
+
+    if (!ReadArrays()) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        throw std::runtime_error("Invalid multitree snapshot.");
+    }
+}
+
+MultitreeSnapshot::~MultitreeSnapshot() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+}
+
+bool MultitreeSnapshot::ReadArrays() {
+    const char* data = static_cast<const char*>(data_);
+    MultitreeSnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kMultitreeSnapshotVersion ||
+        header.num_vertices == 0 || header.num_vertices > INT_MAX ||
+        header.num_components > INT_MAX || header.num_paths > INT_MAX ||
+        header.num_edges > INT_MAX || header.num_prg_edges > INT_MAX) {
+        return false;
+    }
+
+    ArrayReader reader(data + sizeof(header), size_ - sizeof(header));
+    multitree_.num_rows = header.num_vertices;
+    multitree_.offsets = reader.Next<uint64_t>(header.num_vertices + 1);
+    multitree_.values = reader.Next<uint32_t>(header.num_edges);
+    components_.num_rows = header.num_components;
+    components_.offsets = reader.Next<uint64_t>(header.num_components + 1);
+    components_.values =
+        reader.Next<uint32_t>(header.num_component_vertices);
+    paths_ = reader.Next<uint32_t>(2 * header.num_paths);
+    path_relation_graph_.num_rows = header.num_paths;
+    path_relation_graph_.offsets =
+        reader.Next<uint64_t>(header.num_paths + 1);
+    path_relation_graph_.values = reader.Next<uint32_t>(header.num_prg_edges);
+    if (multitree_.offsets == nullptr || multitree_.values == nullptr ||
+        components_.offsets == nullptr || components_.values == nullptr ||
+        paths_ == nullptr || path_relation_graph_.offsets == nullptr ||
+        path_relation_graph_.values == nullptr) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < 2 * header.num_paths; ++i) {
+        if (paths_[i] >= header.num_vertices) {
+            return false;
+        }
+    }
+    return IsValidRows(multitree_, header.num_edges, header.num_vertices) &&
+           IsValidRows(components_, header.num_component_vertices,
+                       header.num_vertices) &&
+           IsValidRows(path_relation_graph_, header.num_prg_edges,
+                       header.num_paths);
+}
+}  // namespace FTMR
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "directed_graph.hpp"
+
+namespace FTMR {
+
+// Snapshot of the precomputed state of a MultitreeRecolorability: the
+// multitree, its unilaterally connected components, the paths and the path
+// relation graph.
+//
+// The file starts with a 64 byte header, all fields in host byte order:
+//
+//   char     magic[8]     "FTMRSNAP"
+//   uint32_t version      kMultitreeSnapshotVersion
+//   uint32_t num_vertices
+//   uint64_t num_edges    edges of the multitree
+//   uint64_t num_components
+//   uint64_t num_component_vertices
+//   uint64_t num_paths
+//   uint64_t num_prg_edges
+//   uint64_t reserved
+//
+// followed by these arrays, each padded with zeros to a multiple of 8 bytes:
+//
+//   uint64_t multitree_offsets[num_vertices + 1]
+//   uint32_t multitree_targets[num_edges]
+//   uint64_t component_offsets[num_components + 1]
+//   uint32_t component_vertices[num_component_vertices]
+//   uint32_t paths[2 num_paths]         first and last vertex of each path
+//   uint64_t prg_offsets[num_paths + 1]
+//   uint32_t prg_targets[num_prg_edges]
+//
+// Every offsets/values pair is in CSR form: row i is values[offsets[i]] to
+// values[offsets[i + 1] - 1]. The rows of the graphs list the out-neighbors
+// in adjacency list order, and the rows of the components list the vertices
+// in topological order.
+constexpr uint32_t kMultitreeSnapshotVersion = 1;
+
+// Rows of one CSR array of a snapshot.
+struct CompressedRows {
+    int num_rows;
+    const uint64_t* offsets;
+    const uint32_t* values;
+
+    int RowSize(int row) const { return offsets[row + 1] - offsets[row]; }
+
+    const uint32_t* RowBegin(int row) const { return values + offsets[row]; }
+
+    const uint32_t* RowEnd(int row) const {
+        return values + offsets[row + 1];
+    }
+};
+
+// Throws std::runtime_error if the file cannot be written.
+void WriteMultitreeSnapshot(
+    const std::string& filename, const DirectedGraph& multitree,
+    const std::vector<std::vector<int>>& unilaterally_connected_components,
+    const std::vector<std::pair<int, int>>& paths,
+    const DirectedGraph& path_relation_graph);
+
+// Read-only view of a snapshot file mapped into memory. Nothing is copied:
+// the arrays point into the mapping, which lives as long as the view. The
+// arrays are checked once when the file is opened, so that the rows can be
+// used without bounds checks. Building a MultitreeRecolorability from a
+// view does copy the rows.
+class MultitreeSnapshot {
+   public:
+    // Throws std::runtime_error if the file cannot be mapped or is not a
+    // valid snapshot.
+    explicit MultitreeSnapshot(const std::string& filename);
+
+    ~MultitreeSnapshot();
+
+    MultitreeSnapshot(const MultitreeSnapshot&) = delete;
+
+    MultitreeSnapshot& operator=(const MultitreeSnapshot&) = delete;
+
+    int NumVertices() const { return multitree_.num_rows; }
+
+    int NumPaths() const { return path_relation_graph_.num_rows; }
+
+    const CompressedRows& Multitree() const { return multitree_; }
+
+    const CompressedRows& UnilaterallyConnectedComponents() const {
+        return components_;
+    }
+
+    const CompressedRows& PathRelationGraph() const {
+        return path_relation_graph_;
+    }
+
+    std::pair<int, int> GetPath(int path_number) const {
+        return {paths_[2 * path_number], paths_[2 * path_number + 1]};
+    }
+
+   private:
+    void* data_;
+    size_t size_;
+
+    CompressedRows multitree_;
+    CompressedRows components_;
+    const uint32_t* paths_;
+    CompressedRows path_relation_graph_;
+
+    // Locates and checks the arrays after the header. Returns false if the
+    // file is not a valid snapshot.
+    bool ReadArrays();
+};
+
+}  // namespace FTMR
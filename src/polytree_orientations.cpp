@@ -0,0 +1,415 @@
+#include "polytree_orientations.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <stdexcept>
+
+namespace FTMR {
+namespace {
+// Bit k of kLanePatterns[i] is bit i of k, the flip bits of the low edges
+// for the 64 lanes of one word.
+constexpr uint64_t kLanePatterns[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL};
+
+// kWords words of 64 lanes. The operations are plain loops over the words,
+// which compilers turn into vector instructions when they are enabled.
+template <int kWords>
+struct Lanes {
+    uint64_t words[kWords];
+
+    static Lanes Zero() {
+        Lanes result;
+        for (int w = 0; w < kWords; ++w) {
+            result.words[w] = 0;
+        }
+        return result;
+    }
+
+    Lanes operator&(const Lanes& other) const {
+        Lanes result;
+        for (int w = 0; w < kWords; ++w) {
+            result.words[w] = words[w] & other.words[w];
+        }
+        return result;
+    }
+
+    Lanes operator|(const Lanes& other) const {
+        Lanes result;
+        for (int w = 0; w < kWords; ++w) {
+            result.words[w] = words[w] | other.words[w];
+        }
+        return result;
+    }
+
+    Lanes operator~() const {
+        Lanes result;
+        for (int w = 0; w < kWords; ++w) {
+            result.words[w] = ~words[w];
+        }
+        return result;
+    }
+
+    Lanes& operator|=(const Lanes& other) {
+        for (int w = 0; w < kWords; ++w) {
+            words[w] |= other.words[w];
+        }
+        return *this;
+    }
+};
+
+// State of a vertex while counting: its indegree and outdegree so far, both
+// capped at 2, whether a splitting vertex below reaches it, and whether it
+// reaches a merging vertex below.
+constexpr int kNumCountStates = 3 * 3 * 2 * 2;
+
+int CountState(int in_degree, int out_degree, bool is_reached,
+               bool is_reaching) {
+    return ((std::min(in_degree, 2) * 3 + std::min(out_degree, 2)) * 2 +
+            is_reached) *
+               2 +
+           is_reaching;
+}
+
+// Saturating counter of 0, 1 or at least 2 per lane.
+template <int kWords>
+void AddToCounter(Lanes<kWords>& at_least_1, Lanes<kWords>& at_least_2,
+                  const Lanes<kWords>& lanes) {
+    at_least_2 |= at_least_1 & lanes;
+    at_least_1 |= lanes;
+}
+}  // namespace
+
+TreeOrientations::TreeOrientations(
+    const std::vector<std::pair<int, int>>& edges, int num_vertices)
+    : num_vertices_(num_vertices) {
+    if (num_vertices <= 0 || num_vertices > kMaxVertices ||
+        edges.size() != num_vertices - 1) {
+        throw std::invalid_argument(
+            "Edges must form a tree with 1 to 64 vertices.");
+    }
+
+    std::vector<std::vector<int>> incident_edges(num_vertices);
+    for (int i = 0; i < edges.size(); ++i) {
+        if (edges[i].first < 0 || edges[i].first >= num_vertices ||
+            edges[i].second < 0 || edges[i].second >= num_vertices) {
+            throw std::invalid_argument(
+                "Vertex number in edges list must be 0 to n - 1.");
+        }
+        incident_edges[edges[i].first].push_back(i);
+        incident_edges[edges[i].second].push_back(i);
+    }
+
+    parent_.assign(num_vertices, -1);
+    parent_edge_.assign(num_vertices, -1);
+    is_edge_to_parent_.assign(num_vertices, false);
+    std::vector<bool> is_visited(num_vertices, false);
+    std::vector<int> stack = {0};
+    is_visited[0] = true;
+    while (!stack.empty()) {
+        int vertex = stack.back();
+        stack.pop_back();
+        preorder_.push_back(vertex);
+        for (auto& edge_index : incident_edges[vertex]) {
+            const std::pair<int, int>& edge = edges[edge_index];
+            int child = edge.first == vertex ? edge.second : edge.first;
+            if (is_visited[child]) {
+                continue;
+            }
+            is_visited[child] = true;
+            parent_[child] = vertex;
+            parent_edge_[child] = edge_index;
+            is_edge_to_parent_[child] = edge.first == child;
+            stack.push_back(child);
+        }
+    }
+
+    if (preorder_.size() != num_vertices) {
+        throw std::invalid_argument("Edges must form a tree.");
+    }
+}
+
+uint64_t TreeOrientations::ConditionSMask(uint64_t first_flip_bits) const {
+    uint64_t mask;
+    EvaluateConditionS<1>(first_flip_bits, &mask);
+    return mask;
+}
+
+void TreeOrientations::ConditionSMasks(uint64_t first_flip_bits,
+                                       uint64_t masks[4]) const {
+    EvaluateConditionS<4>(first_flip_bits, masks);
+}
+
+/* Every path x -> y of the tree climbs to the vertex w on it nearest to the
+ * root and then descends, so a violation of (S) is seen at w: x is w or a
+ * splitting vertex reaching w through an edge from a child, and y is w or a
+ * merging vertex reached through an edge to a child.
+ *
+ * Going up in reverse preorder, states[v] counts the orientations of the
+ * edges below v by CountState. When v is done, up[v][f] counts those where
+ * the edge to the parent points up and f tells whether v is or is reached
+ * by a splitting vertex, and down[v][f] those where it points down and f
+ * tells whether v is or reaches a merging vertex. The orientations with a
+ * violation below v are dropped on the way. */
+uint64_t TreeOrientations::CountConditionS() const {
+    using States = std::array<uint64_t, kNumCountStates>;
+    std::vector<States> states(num_vertices_);
+    for (auto& vertex_states : states) {
+        vertex_states.fill(0);
+        vertex_states[CountState(0, 0, false, false)] = 1;
+    }
+    std::vector<std::array<uint64_t, 2>> up(num_vertices_);
+    std::vector<std::array<uint64_t, 2>> down(num_vertices_);
+
+    uint64_t num_satisfying = 0;
+    for (int i = num_vertices_ - 1; i >= 0; --i) {
+        int vertex = preorder_[i];
+        up[vertex] = {0, 0};
+        down[vertex] = {0, 0};
+        for (int state = 0; state < kNumCountStates; ++state) {
+            uint64_t count = states[vertex][state];
+            if (count == 0) {
+                continue;
+            }
+            int in_degree = state / 12;
+            int out_degree = state / 4 % 3;
+            bool is_reached = state / 2 % 2;
+            bool is_reaching = state % 2;
+
+            // direction 0: edge to the parent points up, 1: down, 2: root.
+            for (int direction = 0; direction < (i == 0 ? 1 : 2);
+                 ++direction) {
+                int in = in_degree + (i > 0 && direction == 1);
+                int out = out_degree + (i > 0 && direction == 0);
+                bool is_splitting = in >= 1 && out >= 2;
+                bool is_merging = in >= 2 && out >= 1;
+                if ((is_reached && (is_merging || is_reaching)) ||
+                    (is_splitting && is_reaching)) {
+                    continue;
+                }
+                if (i == 0) {
+                    num_satisfying += count;
+                } else if (direction == 0) {
+                    up[vertex][is_splitting || is_reached] += count;
+                } else {
+                    down[vertex][is_merging || is_reaching] += count;
+                }
+            }
+        }
+        if (i == 0) {
+            break;
+        }
+
+        // Adds the edge to the parent in both directions.
+        int parent = parent_[vertex];
+        States merged;
+        merged.fill(0);
+        for (int state = 0; state < kNumCountStates; ++state) {
+            uint64_t count = states[parent][state];
+            if (count == 0) {
+                continue;
+            }
+            int in_degree = state / 12;
+            int out_degree = state / 4 % 3;
+            bool is_reached = state / 2 % 2;
+            bool is_reaching = state % 2;
+            for (int flag = 0; flag < 2; ++flag) {
+                merged[CountState(in_degree + 1, out_degree,
+                                  is_reached || flag, is_reaching)] +=
+                    count * up[vertex][flag];
+                merged[CountState(in_degree, out_degree + 1, is_reached,
+                                  is_reaching || flag)] +=
+                    count * down[vertex][flag];
+            }
+        }
+        states[parent] = merged;
+    }
+    return num_satisfying;
+}
+
+/* (S) fails iff some vertex x with indegree >= 1 and outdegree >= 2 reaches
+ * another vertex y with indegree >= 2 and outdegree >= 1: x is then a
+ * splitting vertex that is not first and y a merging vertex that is not last
+ * on a unilateral component through both.
+ *
+ * Each lane is one orientation. After counting the degrees, a pass up the
+ * tree computes sub[v], the lanes where such an x in the subtree of v reaches
+ * v, and a pass down computes top[v], the lanes where one outside the
+ * subtree reaches v. */
+template <int kWords>
+void TreeOrientations::EvaluateConditionS(uint64_t first_flip_bits,
+                                          uint64_t* masks) const {
+    using LaneBlock = Lanes<kWords>;
+
+    // to_parent[v]: lanes where the edge between v and its parent points to
+    // the parent.
+    LaneBlock to_parent[kMaxVertices];
+    LaneBlock in1[kMaxVertices];
+    LaneBlock in2[kMaxVertices];
+    LaneBlock out1[kMaxVertices];
+    LaneBlock out2[kMaxVertices];
+    for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+        in1[vertex] = in2[vertex] = LaneBlock::Zero();
+        out1[vertex] = out2[vertex] = LaneBlock::Zero();
+    }
+
+    for (int i = 1; i < num_vertices_; ++i) {
+        int vertex = preorder_[i];
+        int edge_index = parent_edge_[vertex];
+        LaneBlock flipped;
+        for (int w = 0; w < kWords; ++w) {
+            if (edge_index < 6) {
+                flipped.words[w] = kLanePatterns[edge_index];
+            } else {
+                uint64_t flip_bits = first_flip_bits + 64 * uint64_t(w);
+                flipped.words[w] = (flip_bits >> edge_index) & 1 ? ~0ULL : 0;
+            }
+        }
+        to_parent[vertex] = is_edge_to_parent_[vertex] ? ~flipped : flipped;
+
+        LaneBlock to_child = ~to_parent[vertex];
+        int parent = parent_[vertex];
+        AddToCounter(out1[vertex], out2[vertex], to_parent[vertex]);
+        AddToCounter(in1[parent], in2[parent], to_parent[vertex]);
+        AddToCounter(in1[vertex], in2[vertex], to_child);
+        AddToCounter(out1[parent], out2[parent], to_child);
+    }
+
+    LaneBlock splitting[kMaxVertices];
+    LaneBlock sub[kMaxVertices];
+    for (int vertex = 0; vertex < num_vertices_; ++vertex) {
+        splitting[vertex] = in1[vertex] & out2[vertex];
+        sub[vertex] = LaneBlock::Zero();
+    }
+
+    for (int i = num_vertices_ - 1; i > 0; --i) {
+        int vertex = preorder_[i];
+        sub[parent_[vertex]] |=
+            to_parent[vertex] & (splitting[vertex] | sub[vertex]);
+    }
+
+    // In the lanes where the edge points down to vertex, vertex itself does
+    // not reach its parent, so sub[parent] can be used as it is.
+    LaneBlock top[kMaxVertices];
+    LaneBlock failed = LaneBlock::Zero();
+    top[preorder_[0]] = LaneBlock::Zero();
+    for (int i = 0; i < num_vertices_; ++i) {
+        int vertex = preorder_[i];
+        if (i > 0) {
+            int parent = parent_[vertex];
+            top[vertex] = ~to_parent[vertex] &
+                          (splitting[parent] | top[parent] | sub[parent]);
+        }
+        LaneBlock merging = in2[vertex] & out1[vertex];
+        failed |= merging & (sub[vertex] | top[vertex]);
+    }
+
+    for (int w = 0; w < kWords; ++w) {
+        uint64_t first = first_flip_bits + 64 * uint64_t(w);
+        uint64_t num_valid = first >= NumOrientations()
+                                 ? 0
+                                 : NumOrientations() - first;
+        uint64_t valid = num_valid >= 64 ? ~0ULL : (1ULL << num_valid) - 1;
+        masks[w] = ~failed.words[w] & valid;
+    }
+}
+
+PolytreeSkeleton::PolytreeSkeleton(
+    const std::vector<std::pair<int, int>>& edges, int num_vertices)
+    : num_vertices_(num_vertices), edges_(edges) {
+    if (num_vertices <= 0 || num_vertices > kMaxVertices ||
+        edges.size() != num_vertices - 1) {
+        throw std::invalid_argument(
+            "Edges must form a tree with 1 to 64 vertices.");
+    }
+
+    incident_edges_.assign(num_vertices, 0);
+    head_edges_.assign(num_vertices, 0);
+    std::vector<std::vector<int>> incident_edges(num_vertices);
+    for (int i = 0; i < edges.size(); ++i) {
+        if (edges[i].first < 0 || edges[i].first >= num_vertices ||
+            edges[i].second < 0 || edges[i].second >= num_vertices) {
+            throw std::invalid_argument(
+                "Vertex number in edges list must be 0 to n - 1.");
+        }
+        incident_edges[edges[i].first].push_back(i);
+        incident_edges[edges[i].second].push_back(i);
+        incident_edges_[edges[i].first] |= uint64_t(1) << i;
+        incident_edges_[edges[i].second] |= uint64_t(1) << i;
+        head_edges_[edges[i].second] |= uint64_t(1) << i;
+    }
+
+    // A search from every vertex extends the path masks one edge at a time.
+    // The first search, from the root, also sets the parents and depths, so
+    // the lowest common ancestor is the shallowest vertex of each path.
+    parent_.assign(num_vertices, -1);
+    depth_.assign(num_vertices, 0);
+    path_edges_.assign(num_vertices * num_vertices, 0);
+    toward_edges_.assign(num_vertices * num_vertices, 0);
+    lowest_common_ancestors_.assign(num_vertices * num_vertices, -1);
+    std::vector<int> stack;
+    for (int start = 0; start < num_vertices; ++start) {
+        uint64_t* path_edges = &path_edges_[start * num_vertices];
+        uint64_t* toward_edges = &toward_edges_[start * num_vertices];
+        int* ancestors = &lowest_common_ancestors_[start * num_vertices];
+        ancestors[start] = start;
+        int num_visited = 1;
+        stack.assign(1, start);
+        while (!stack.empty()) {
+            int vertex = stack.back();
+            stack.pop_back();
+            for (auto& edge_index : incident_edges[vertex]) {
+                const std::pair<int, int>& edge = edges[edge_index];
+                int next = edge.first == vertex ? edge.second : edge.first;
+                if (ancestors[next] != -1) {
+                    continue;
+                }
+                if (start == 0) {
+                    parent_[next] = vertex;
+                    depth_[next] = depth_[vertex] + 1;
+                }
+                uint64_t edge_bit = uint64_t(1) << edge_index;
+                path_edges[next] = path_edges[vertex] | edge_bit;
+                toward_edges[next] =
+                    toward_edges[vertex] | (edge.second == next ? edge_bit : 0);
+                ancestors[next] = depth_[next] < depth_[ancestors[vertex]]
+                                      ? next
+                                      : ancestors[vertex];
+                ++num_visited;
+                stack.push_back(next);
+            }
+        }
+        if (num_visited != num_vertices) {
+            throw std::invalid_argument("Edges must form a tree.");
+        }
+    }
+}
+
+int PolytreeSkeleton::InDegree(int vertex, uint64_t flip_bits) const {
+    return std::bitset<64>(incident_edges_[vertex] &
+                           (head_edges_[vertex] ^ flip_bits))
+        .count();
+}
+
+int PolytreeSkeleton::OutDegree(int vertex, uint64_t flip_bits) const {
+    return std::bitset<64>(incident_edges_[vertex] &
+                           ~(head_edges_[vertex] ^ flip_bits))
+        .count();
+}
+
+std::vector<int> PolytreeSkeleton::Path(int vertex1, int vertex2) const {
+    int ancestor = LowestCommonAncestor(vertex1, vertex2);
+    std::vector<int> path;
+    for (int vertex = vertex1; vertex != ancestor; vertex = parent_[vertex]) {
+        path.push_back(vertex);
+    }
+    int middle = path.size();
+    path.push_back(ancestor);
+    for (int vertex = vertex2; vertex != ancestor; vertex = parent_[vertex]) {
+        path.push_back(vertex);
+    }
+    std::reverse(path.begin() + middle + 1, path.end());
+    return path;
+}
+}  // namespace FTMR
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace FTMR {
+
+// The 2^(n-1) orientations of a tree. Orientation flip_bits reverses edge i
+// of the tree when bit i is set, like the search over the trees data.
+class TreeOrientations {
+   public:
+    static constexpr int kMaxVertices = 64;
+
+    TreeOrientations() = default;
+
+    ~TreeOrientations() = default;
+
+    // Throws std::invalid_argument if the edges do not form a tree with 1 to
+    // kMaxVertices vertices.
+    TreeOrientations(const std::vector<std::pair<int, int>>& edges,
+                     int num_vertices);
+
+    int NumVertices() const { return num_vertices_; }
+
+    uint64_t NumOrientations() const {
+        return uint64_t(1) << (num_vertices_ - 1);
+    }
+
+    // Bit k of the result is set iff orientation first_flip_bits + k
+    // satisfies (S). first_flip_bits must be a multiple of 64, and the bits
+    // past the last orientation are 0.
+    uint64_t ConditionSMask(uint64_t first_flip_bits) const;
+
+    // Same for 256 orientations: masks[w] covers first_flip_bits + 64 w to
+    // first_flip_bits + 64 w + 63. first_flip_bits must be a multiple of 256.
+    void ConditionSMasks(uint64_t first_flip_bits, uint64_t masks[4]) const;
+
+    // Returns the number of orientations satisfying (S), in O(n) time
+    // without enumerating them.
+    uint64_t CountConditionS() const;
+
+   private:
+    int num_vertices_ = 0;
+
+    // Vertices in DFS preorder from vertex 0. For every other vertex,
+    // parent_edge_ is the index of the edge to its parent and
+    // is_edge_to_parent_ tells whether that edge points to the parent
+    // before flipping.
+    std::vector<int> preorder_;
+    std::vector<int> parent_;
+    std::vector<int> parent_edge_;
+    std::vector<bool> is_edge_to_parent_;
+
+    template <int kWords>
+    void EvaluateConditionS(uint64_t first_flip_bits, uint64_t* masks) const;
+};
+
+// The facts about a tree that do not depend on its orientation, computed
+// once and shared by all 2^(n-1) orientations. Orientations are numbered by
+// flip bits like in TreeOrientations, and the tree is rooted at vertex 0.
+class PolytreeSkeleton {
+   public:
+    static constexpr int kMaxVertices = 64;
+
+    PolytreeSkeleton() = default;
+
+    ~PolytreeSkeleton() = default;
+
+    // Throws std::invalid_argument if the edges do not form a tree with 1 to
+    // kMaxVertices vertices.
+    PolytreeSkeleton(const std::vector<std::pair<int, int>>& edges,
+                     int num_vertices);
+
+    int NumVertices() const { return num_vertices_; }
+
+    uint64_t NumOrientations() const {
+        return uint64_t(1) << (num_vertices_ - 1);
+    }
+
+    // Returns edge i of the orientation.
+    std::pair<int, int> GetEdge(int edge_index, uint64_t flip_bits) const {
+        const std::pair<int, int>& edge = edges_[edge_index];
+        return (flip_bits >> edge_index) & 1
+                   ? std::pair<int, int>(edge.second, edge.first)
+                   : edge;
+    }
+
+    int InDegree(int vertex, uint64_t flip_bits) const;
+
+    int OutDegree(int vertex, uint64_t flip_bits) const;
+
+    // Bit i is set iff edge i is on the path between vertex1 and vertex2.
+    uint64_t PathEdges(int vertex1, int vertex2) const {
+        return path_edges_[vertex1 * num_vertices_ + vertex2];
+    }
+
+    // Returns true iff every edge on the path from vertex_start to
+    // vertex_end points toward vertex_end, which holds when they are equal.
+    bool Reaches(int vertex_start, int vertex_end, uint64_t flip_bits) const {
+        int index = vertex_start * num_vertices_ + vertex_end;
+        return ((toward_edges_[index] ^ flip_bits) & path_edges_[index]) ==
+               path_edges_[index];
+    }
+
+    int Depth(int vertex) const { return depth_[vertex]; }
+
+    int LowestCommonAncestor(int vertex1, int vertex2) const {
+        return lowest_common_ancestors_[vertex1 * num_vertices_ + vertex2];
+    }
+
+    // Returns the vertices of the path from vertex1 to vertex2 in order,
+    // both included.
+    std::vector<int> Path(int vertex1, int vertex2) const;
+
+   private:
+    int num_vertices_ = 0;
+    std::vector<std::pair<int, int>> edges_;
+    std::vector<int> parent_;
+    std::vector<int> depth_;
+
+    // incident_edges_[v] has bit i set iff edge i touches v, and
+    // head_edges_[v] iff edge i points to v before flipping.
+    std::vector<uint64_t> incident_edges_;
+    std::vector<uint64_t> head_edges_;
+
+    // Indexed by vertex1 * n + vertex2. toward_edges_ holds the edges of the
+    // path that point toward vertex2 before flipping.
+    std::vector<uint64_t> path_edges_;
+    std::vector<uint64_t> toward_edges_;
+    std::vector<int> lowest_common_ancestors_;
+};
+
+}  // namespace FTMR
@@ -0,0 +1,175 @@
+#include "progress_reporter.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace FTMR {
+namespace {
+constexpr int kCacheLineCounters = 64 / sizeof(uint64_t);
+
+// Formats seconds as h:mm:ss.
+std::string FormatDuration(double seconds) {
+    long long total_seconds = static_cast<long long>(seconds + 0.5);
+    std::ostringstream stream;
+    stream << total_seconds / 3600 << ':' << std::setw(2) << std::setfill('0')
+           << total_seconds / 60 % 60 << ':' << std::setw(2)
+           << std::setfill('0') << total_seconds % 60;
+    return stream.str();
+}
+}  // namespace
+
+ProgressReporter::ProgressReporter(const std::string& item_name,
+                                   const std::vector<std::string>& class_names,
+                                   int num_workers, uint64_t total,
+                                   std::chrono::milliseconds interval,
+                                   bool print_to_stderr,
+                                   const std::string& status_file)
+    : item_name_(item_name),
+      class_names_(class_names),
+      total_(total),
+      interval_(interval),
+      print_to_stderr_(print_to_stderr),
+      status_file_(status_file),
+      num_workers_(num_workers),
+      stride_((class_names.size() + kCacheLineCounters - 1) /
+                  kCacheLineCounters * kCacheLineCounters +
+              kCacheLineCounters),
+      counts_(),
+      start_time_(),
+      is_stopped_(true) {
+    if (num_workers <= 0) {
+        throw std::invalid_argument("Number of workers must be positive.");
+    }
+    counts_.reset(new std::atomic<uint64_t>[num_workers_ * stride_]);
+    for (int i = 0; i < num_workers_ * stride_; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+ProgressReporter::~ProgressReporter() {
+    if (sampler_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            is_stopped_ = true;
+        }
+        stop_condition_.notify_all();
+        sampler_.join();
+    }
+}
+
+void ProgressReporter::Start() {
+    start_time_ = std::chrono::steady_clock::now();
+    is_stopped_ = false;
+    sampler_ = std::thread(&ProgressReporter::Run, this);
+}
+
+void ProgressReporter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (is_stopped_) {
+            return;
+        }
+        is_stopped_ = true;
+    }
+    stop_condition_.notify_all();
+    sampler_.join();
+    Report(true);
+}
+
+void ProgressReporter::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_condition_.wait_for(lock, interval_,
+                                     [this]() { return is_stopped_; })) {
+        lock.unlock();
+        Report(false);
+        lock.lock();
+    }
+}
+
+void ProgressReporter::Report(bool is_finished) {
+    std::vector<uint64_t> counts(class_names_.size(), 0);
+    uint64_t done = 0;
+    for (int i = 0; i < counts.size(); ++i) {
+        for (int worker = 0; worker < num_workers_; ++worker) {
+            counts[i] += counts_[worker * stride_ + i].load(
+                std::memory_order_relaxed);
+        }
+        done += counts[i];
+    }
+
+    double elapsed_seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start_time_)
+                                 .count();
+    double rate = elapsed_seconds > 0 ? done / elapsed_seconds : 0;
+    double eta_seconds = -1;
+    if (total_ > 0 && rate > 0) {
+        eta_seconds = total_ > done ? (total_ - done) / rate : 0;
+    }
+
+    if (print_to_stderr_) {
+        std::ostringstream line;
+        line << (is_finished ? "Finished: " : "Progress: ") << done;
+        if (total_ > 0) {
+            line << " / " << total_ << ' ' << item_name_ << " (" << std::fixed
+                 << std::setprecision(1) << 100.0 * done / total_ << "%)";
+        } else {
+            line << ' ' << item_name_;
+        }
+        line << ", " << std::fixed << std::setprecision(0) << rate << " /s, "
+             << "elapsed " << FormatDuration(elapsed_seconds);
+        if (!is_finished && eta_seconds >= 0) {
+            line << ", ETA " << FormatDuration(eta_seconds);
+        }
+        line << '.';
+        for (int i = 0; i < counts.size(); ++i) {
+            line << (i == 0 ? " " : ", ") << class_names_[i] << ' '
+                 << counts[i];
+        }
+        std::cerr << line.str() << std::endl;
+    }
+
+    if (!status_file_.empty()) {
+        WriteStatusFile(counts, done, elapsed_seconds, rate, eta_seconds,
+                        is_finished);
+    }
+}
+
+/* Writes to a temporary file and renames it over the status file, so that
+ * readers never see a partial file. */
+void ProgressReporter::WriteStatusFile(const std::vector<uint64_t>& counts,
+                                       uint64_t done, double elapsed_seconds,
+                                       double rate, double eta_seconds,
+                                       bool is_finished) const {
+    std::string temporary_file = status_file_ + ".tmp";
+    {
+        std::ofstream file(temporary_file);
+        if (!file) {
+            return;
+        }
+
+        file << std::fixed << std::setprecision(3);
+        file << "{\"items\": \"" << item_name_ << "\", \"done\": " << done
+             << ", \"total\": " << total_ << ", \"percent\": "
+             << (total_ > 0 ? 100.0 * done / total_ : 0.0)
+             << ", \"elapsed_seconds\": " << elapsed_seconds
+             << ", \"rate\": " << rate << ", \"eta_seconds\": ";
+        if (eta_seconds >= 0) {
+            file << eta_seconds;
+        } else {
+            file << "null";
+        }
+        file << ", \"finished\": " << (is_finished ? "true" : "false")
+             << ", \"counts\": {";
+        for (int i = 0; i < counts.size(); ++i) {
+            file << (i == 0 ? "" : ", ") << '"' << class_names_[i]
+                 << "\": " << counts[i];
+        }
+        file << "}}\n";
+    }
+    std::rename(temporary_file.c_str(), status_file_.c_str());
+}
+}  // namespace FTMR
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace FTMR {
+
+// Reports the progress of a long search from a sampling thread. Workers
+// only increment relaxed atomic counters, one per class of result, in a
+// block of their own so that they never share a cache line. Every interval
+// the sampler sums the blocks, prints the rate, percent done, ETA and the
+// counts to stderr and rewrites the JSON status file, if any. The status
+// file is replaced atomically, so it can be read at any time.
+class ProgressReporter {
+   public:
+    // Workers are numbered 0 to num_workers - 1. total is the number of
+    // items expected, or 0 if unknown. An empty status_file writes no file.
+    // Throws std::invalid_argument if num_workers is not positive.
+    ProgressReporter(const std::string& item_name,
+                     const std::vector<std::string>& class_names,
+                     int num_workers, uint64_t total,
+                     std::chrono::milliseconds interval,
+                     bool print_to_stderr, const std::string& status_file);
+
+    // Stops the sampling thread.
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    // Counts one item of the class. Each worker must use its own index.
+    void Add(int worker_index, int class_index) {
+        counts_[worker_index * stride_ + class_index].fetch_add(
+            1, std::memory_order_relaxed);
+    }
+
+    // Counts count items of the class at once.
+    void Add(int worker_index, int class_index, uint64_t count) {
+        counts_[worker_index * stride_ + class_index].fetch_add(
+            count, std::memory_order_relaxed);
+    }
+
+    void Start();
+
+    // Stops the sampling thread and reports the final counts.
+    void Stop();
+
+   private:
+    std::string item_name_;
+    std::vector<std::string> class_names_;
+    uint64_t total_;
+    std::chrono::milliseconds interval_;
+    bool print_to_stderr_;
+    std::string status_file_;
+
+    // Worker w counts class c in counts_[w * stride_ + c]. stride_ leaves at
+    // least a cache line between the blocks.
+    int num_workers_;
+    int stride_;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::chrono::steady_clock::time_point start_time_;
+
+    std::thread sampler_;
+    std::mutex mutex_;
+    std::condition_variable stop_condition_;
+    bool is_stopped_;
+
+    void Run();
+
+    void Report(bool is_finished);
+
+    void WriteStatusFile(const std::vector<uint64_t>& counts, uint64_t done,
+                         double elapsed_seconds, double rate,
+                         double eta_seconds, bool is_finished) const;
+};
+
+}  // namespace FTMR
@@ -0,0 +1,175 @@
+#include "tree_catalog.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace FTMR {
+namespace {
+constexpr char kMagic[8] = {'F', 'T', 'M', 'R', 'T', 'R', 'E', 'E'};
+
+struct TreeCatalogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_vertices;
+    uint64_t num_trees;
+    uint32_t encoding;
+    uint32_t reserved;
+};
+}  // namespace
+
+uint64_t EncodeTree(const std::vector<std::pair<int, int>>& edges,
+                    int num_vertices) {
+    if (num_vertices <= 0 || num_vertices > kMaxTreeCatalogVertices ||
+        edges.size() != num_vertices - 1) {
+        throw std::invalid_argument(
+            "Edges must form a tree with 1 to 33 vertices.");
+    }
+
+    std::vector<std::vector<int>> adjacent_vertices(num_vertices);
+    for (auto& edge : edges) {
+        if (edge.first < 0 || edge.first >= num_vertices || edge.second < 0 ||
+            edge.second >= num_vertices) {
+            throw std::invalid_argument(
+                "Vertex number in edges list must be 0 to n - 1.");
+        }
+        adjacent_vertices[edge.first].push_back(edge.second);
+        adjacent_vertices[edge.second].push_back(edge.first);
+    }
+
+    // Preorder DFS from the root, emitting the climb to the next vertex.
+    uint64_t code = 0;
+    int num_bits = 0;
+    int num_visited = 0;
+    int previous_level = -1;
+    std::vector<bool> is_visited(num_vertices, false);
+    std::vector<std::pair<int, int>> stack = {{num_vertices - 1, 0}};
+    while (!stack.empty()) {
+        int vertex = stack.back().first;
+        int level = stack.back().second;
+        stack.pop_back();
+        if (is_visited[vertex]) {
+            throw std::invalid_argument("Edges must form a tree.");
+        }
+        is_visited[vertex] = true;
+        ++num_visited;
+
+        if (previous_level >= 0) {
+            int climb = previous_level + 1 - level;
+            code |= ((uint64_t(1) << climb) - 1) << num_bits;
+            num_bits += climb + 1;
+        }
+        previous_level = level;
+
+        auto& children = adjacent_vertices[vertex];
+        for (auto itr = children.rbegin(); itr != children.rend(); ++itr) {
+            if (!is_visited[*itr]) {
+                stack.push_back({*itr, level + 1});
+            }
+        }
+    }
+
+    if (num_visited != num_vertices) {
+        throw std::invalid_argument("Edges must form a tree.");
+    }
+    return code;
+}
+
+bool DecodeTree(uint64_t code, int num_vertices, std::pair<int, int>* edges) {
+    // parent_at_level[l] is the last decoded vertex on level l.
+    int parent_at_level[kMaxTreeCatalogVertices];
+    parent_at_level[0] = num_vertices - 1;
+
+    // A climb above the root makes the code invalid. Each vertex is at most
+    // one level below the previous one, so the level stays below
+    // num_vertices, and the bits left after the last vertex must be zero.
+    int level = 0;
+    for (int vertex = 0; vertex < num_vertices - 1; ++vertex) {
+        while (code & 1) {
+            if (level == 0) {
+                return false;
+            }
+            --level;
+            code >>= 1;
+        }
+        code >>= 1;
+        ++level;
+
+        edges[vertex] = {vertex, parent_at_level[level - 1]};
+        parent_at_level[level] = vertex;
+    }
+    return code == 0;
+}
+
+void WriteTreeCatalog(const std::string& filename, int num_vertices,
+                      const std::vector<uint64_t>& codes) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open tree catalog for writing.");
+    }
+
+    TreeCatalogHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kTreeCatalogVersion;
+    header.num_vertices = num_vertices;
+    header.num_trees = codes.size();
+    header.encoding = kLevelSequenceEncoding;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(codes.data()),
+               codes.size() * sizeof(uint64_t));
+    if (!file) {
+        throw std::runtime_error("Cannot write tree catalog.");
+    }
+}
+
+TreeCatalogReader::TreeCatalogReader(const std::string& filename)
+    : file_(filename, std::ios::binary),
+      num_vertices_(0),
+      num_trees_(0),
+      num_read_(0),
+      buffer_(),
+      buffer_position_(0) {
+    TreeCatalogHeader header;
+    if (!file_ ||
+        !file_.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kTreeCatalogVersion ||
+        header.encoding != kLevelSequenceEncoding || header.num_vertices == 0 ||
+        header.num_vertices > kMaxTreeCatalogVertices) {
+        throw std::runtime_error("Invalid tree catalog.");
+    }
+
+    num_vertices_ = header.num_vertices;
+    num_trees_ = header.num_trees;
+    buffer_.reserve(kBufferSize);
+}
+
+bool TreeCatalogReader::Next(std::vector<std::pair<int, int>>& edges) {
+    if (num_read_ == num_trees_) {
+        return false;
+    }
+
+    if (edges.size() != num_vertices_ - 1) {
+        throw std::invalid_argument("Edges must hold n - 1 elements.");
+    }
+
+    if (buffer_position_ == buffer_.size()) {
+        uint64_t num_codes = num_trees_ - num_read_;
+        if (num_codes > kBufferSize) {
+            num_codes = kBufferSize;
+        }
+        buffer_.resize(num_codes);
+        if (!file_.read(reinterpret_cast<char*>(buffer_.data()),
+                        num_codes * sizeof(uint64_t))) {
+            throw std::runtime_error("Invalid tree catalog.");
+        }
+        buffer_position_ = 0;
+    }
+
+    if (!DecodeTree(buffer_[buffer_position_], num_vertices_, edges.data())) {
+        throw std::runtime_error("Invalid tree catalog.");
+    }
+    ++buffer_position_;
+    ++num_read_;
+    return true;
+}
+}  // namespace FTMR
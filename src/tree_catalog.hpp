@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace FTMR {
+
+// Binary catalog of trees with a fixed number of vertices.
+//
+// The file starts with a 32 byte header, all fields in host byte order:
+//
+//   char     magic[8]     "FTMRTREE"
+//   uint32_t version      kTreeCatalogVersion
+//   uint32_t num_vertices
+//   uint64_t num_trees
+//   uint32_t encoding     kLevelSequenceEncoding
+//   uint32_t reserved
+//
+// followed by one uint64_t code per tree. A tree is rooted at vertex n - 1
+// and its level sequence in DFS order is packed as steps: moving from one
+// vertex to the next in preorder writes a 1 bit for every level climbed and
+// then a 0 bit for the step down to the new vertex. That takes at most
+// 2(n - 1) bits, so every tree with up to kMaxTreeCatalogVertices fits in
+// one word.
+constexpr uint32_t kTreeCatalogVersion = 1;
+constexpr uint32_t kLevelSequenceEncoding = 0;
+constexpr int kMaxTreeCatalogVertices = 33;
+
+// Returns the code of the tree given by its edges. Throws
+// std::invalid_argument if the edges do not form a tree.
+uint64_t EncodeTree(const std::vector<std::pair<int, int>>& edges,
+                    int num_vertices);
+
+// Writes the num_vertices - 1 edges of the tree into edges. The root is
+// vertex n - 1 and the other vertices are numbered in preorder, and every
+// edge goes from a vertex to its parent, like the trees data files. Returns
+// false if code is not the code of a tree with num_vertices vertices.
+bool DecodeTree(uint64_t code, int num_vertices, std::pair<int, int>* edges);
+
+void WriteTreeCatalog(const std::string& filename, int num_vertices,
+                      const std::vector<uint64_t>& codes);
+
+class TreeCatalogReader {
+   public:
+    // Throws std::runtime_error if the file cannot be read or is not a tree
+    // catalog.
+    explicit TreeCatalogReader(const std::string& filename);
+
+    ~TreeCatalogReader() = default;
+
+    int NumVertices() const { return num_vertices_; }
+
+    uint64_t NumTrees() const { return num_trees_; }
+
+    // Decodes the next tree into edges, which must already hold
+    // NumVertices() - 1 elements. Returns false after the last tree. Throws
+    // std::runtime_error if the file is truncated or a code is invalid.
+    bool Next(std::vector<std::pair<int, int>>& edges);
+
+   private:
+    static constexpr size_t kBufferSize = 4096;
+
+    std::ifstream file_;
+    int num_vertices_;
+    uint64_t num_trees_;
+    uint64_t num_read_;
+    std::vector<uint64_t> buffer_;
+    size_t buffer_position_;
+};
+
+}  // namespace FTMR
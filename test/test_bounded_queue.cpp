@@ -0,0 +1,82 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.hpp"
+#include "gtest/gtest.h"
+
+namespace FTMR {
+TEST(BoundedQueueTest, FirstInFirstOut) {
+    BoundedQueue<int> queue(3);
+    ASSERT_EQ(4, queue.Capacity());
+
+    for (int i = 0; i < 4; ++i) {
+        int value = i;
+        ASSERT_TRUE(queue.TryPush(value));
+    }
+    int value = 4;
+    ASSERT_FALSE(queue.TryPush(value));
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.TryPop(value));
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_FALSE(queue.TryPop(value));
+}
+
+TEST(BoundedQueueTest, MultipleProducersAndConsumers) {
+    const int kNumThreads = 4;
+    const int kValuesPerThread = 10000;
+    BoundedQueue<int> queue(64);
+
+    std::vector<long long> sums(kNumThreads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads.push_back(std::thread([&queue]() {
+            for (int i = 1; i <= kValuesPerThread; ++i) {
+                queue.Push(i);
+            }
+        }));
+        threads.push_back(std::thread([&queue, &sums, t]() {
+            int value;
+            for (int i = 0; i < kValuesPerThread; ++i) {
+                queue.Pop(value);
+                sums[t] += value;
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    long long total = 0;
+    for (auto& sum : sums) {
+        total += sum;
+    }
+    ASSERT_EQ(kNumThreads * (kValuesPerThread * (kValuesPerThread + 1LL) / 2),
+              total);
+}
+
+TEST(BoundedQueueTest, BlockedThreadsWakeUp) {
+    BoundedQueue<int> queue(1);
+    ASSERT_EQ(2, queue.Capacity());
+    int value = 0;
+    std::thread consumer([&queue, &value]() { queue.Pop(value); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.Push(7);
+    consumer.join();
+    ASSERT_EQ(7, value);
+
+    queue.Push(1);
+    queue.Push(2);
+    std::thread producer([&queue]() { queue.Push(3); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.Pop(value);
+    producer.join();
+    ASSERT_EQ(1, value);
+    queue.Pop(value);
+    ASSERT_EQ(2, value);
+    queue.Pop(value);
+    ASSERT_EQ(3, value);
+}
+}  // namespace FTMR
@@ -0,0 +1,96 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "budget.hpp"
+#include "directed_graph.hpp"
+#include "gtest/gtest.h"
+#include "multitree_recolorability.hpp"
+
+namespace FTMR {
+namespace {
+// Complete digraph, whose number of simple cycles grows factorially.
+DirectedGraph CompleteDigraph(int num_vertices) {
+    std::vector<std::pair<int, int>> edges;
+    for (int u = 0; u < num_vertices; ++u) {
+        for (int v = 0; v < num_vertices; ++v) {
+            if (u != v) {
+                edges.push_back({u, v});
+            }
+        }
+    }
+    return DirectedGraph(edges, num_vertices);
+}
+}  // namespace
+
+TEST(BudgetTest, Deadline) {
+    Budget unlimited;
+    ASSERT_FALSE(unlimited.Expired());
+    unlimited.Cancel();
+    ASSERT_TRUE(unlimited.Expired());
+
+    Budget budget(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(budget.Expired());
+    ASSERT_TRUE(budget.IsCancelled());
+    ASSERT_THROW(CheckBudget(&budget), DeadlineExceeded);
+    CheckBudget(nullptr);
+}
+
+TEST(BudgetTest, SimpleCyclesDeadline) {
+    DirectedGraph digraph = CompleteDigraph(14);
+    for (int num_threads : {1, 4}) {
+        Budget budget(std::chrono::milliseconds(20));
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_THROW(digraph.SimpleCycles(num_threads, budget),
+                     DeadlineExceeded);
+        ASSERT_LT(std::chrono::steady_clock::now() - start,
+                  std::chrono::seconds(2));
+    }
+
+    Budget budget(std::chrono::seconds(10));
+    DirectedGraph small_digraph = CompleteDigraph(4);
+    ASSERT_EQ(small_digraph.SimpleCycles(),
+              small_digraph.SimpleCycles(2, budget));
+}
+
+TEST(BudgetTest, VisitorDecidesBeforeDeadline) {
+    Budget budget(std::chrono::seconds(10));
+    ASSERT_FALSE(CompleteDigraph(14).VisitSimpleCycles(
+        [](const std::vector<int>&) { return false; }, 2, budget));
+}
+
+TEST(BudgetTest, IsMultitreeDeadline) {
+    const std::vector<std::pair<int, int>> diamond = {
+        {0, 1}, {0, 2}, {1, 3}, {2, 3}};
+    Budget budget(std::chrono::seconds(10));
+    ASSERT_FALSE(DirectedGraph(diamond, 4).IsMultitree(budget));
+
+    Budget cancelled;
+    cancelled.Cancel();
+    ASSERT_THROW(DirectedGraph(diamond, 4).IsMultitree(cancelled),
+                 DeadlineExceeded);
+}
+
+TEST(BudgetTest, CheckConditionUnknown) {
+    const std::vector<std::pair<int, int>> edges = {
+        {0, 1}, {1, 2}, {1, 3}, {4, 3}, {3, 5}};
+    MultitreeRecolorability multitree(edges, 6);
+
+    Budget budget(std::chrono::seconds(10));
+    ASSERT_EQ(CheckResult::kNotSatisfied, multitree.CheckConditionS(budget));
+    ASSERT_EQ(multitree.CheckConditionCP() ? CheckResult::kSatisfied
+                                           : CheckResult::kNotSatisfied,
+              multitree.CheckConditionCP(budget));
+
+    Budget cancelled;
+    cancelled.Cancel();
+    ASSERT_EQ(CheckResult::kUnknown, multitree.CheckConditionS(cancelled));
+    ASSERT_EQ(CheckResult::kUnknown, multitree.CheckConditionCP(cancelled));
+    ASSERT_EQ(CheckResult::kUnknown, multitree.CheckConditionCV(cancelled));
+    ASSERT_EQ(CheckResult::kUnknown,
+              multitree.CheckConditionCVPolynomial(cancelled));
+    ASSERT_THROW(MultitreeRecolorability(edges, 6, cancelled),
+                 DeadlineExceeded);
+}
+}  // namespace FTMR
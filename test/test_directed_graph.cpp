@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <stdexcept>
 #include <unordered_set>
 
 #include "directed_graph.hpp"
@@ -23,6 +25,23 @@ TEST(DirectedGraphTest, IsDAG) {
     ASSERT_FALSE(not_dag.IsDAG());
 }
 
+TEST(DirectedGraphTest, IsMultitree) {
+    const std::vector<std::pair<int, int>> edges1 = {
+        {0, 2}, {1, 2}, {2, 3}, {2, 4}, {5, 4}};
+    ASSERT_TRUE(DirectedGraph(edges1, 6).IsMultitree());
+
+    // Two paths from 0 to 3.
+    const std::vector<std::pair<int, int>> diamond = {
+        {0, 1}, {0, 2}, {1, 3}, {2, 3}};
+    ASSERT_FALSE(DirectedGraph(diamond, 4).IsMultitree());
+
+    const std::vector<std::pair<int, int>> parallel_edges = {{0, 1}, {0, 1}};
+    ASSERT_FALSE(DirectedGraph(parallel_edges, 2).IsMultitree());
+
+    const std::vector<std::pair<int, int>> cycle = {{0, 1}, {1, 0}};
+    ASSERT_FALSE(DirectedGraph(cycle, 2).IsMultitree());
+}
+
 TEST(DirectedGraphTest, UnilaterallyConnectedComponents) {
     const std::vector<std::pair<int, int>> edges = {
         {0, 1}, {0, 2}, {0, 3}, {1, 4}, {2, 5}, {2, 6},
@@ -63,6 +82,38 @@ TEST(DirectedGraphTest, SimpleCycles) {
     ASSERT_EQ(expected_vector2, result2);
 }
 
+TEST(DirectedGraphTest, SimpleCyclesParallel) {
+    std::vector<std::pair<int, int>> edges;
+    for (int u = 0; u < 7; ++u) {
+        for (int v = 0; v < 7; ++v) {
+            if (u != v && (u * 3 + v * 5) % 4 != 0) {
+                edges.push_back({u, v});
+            }
+        }
+    }
+    edges.push_back({7, 8});
+    edges.push_back({8, 9});
+    edges.push_back({9, 7});
+    DirectedGraph digraph(edges, 10);
+
+    std::vector<std::vector<int>> expected = digraph.SimpleCycles();
+    ASSERT_LT(100, expected.size());
+    ASSERT_EQ(expected, digraph.SimpleCycles(4));
+
+    std::atomic<int> num_visited(0);
+    ASSERT_TRUE(digraph.VisitSimpleCycles(
+        [&num_visited](const std::vector<int>&) {
+            ++num_visited;
+            return true;
+        },
+        4));
+    ASSERT_EQ(expected.size(), num_visited);
+
+    // The visitor can stop the search once it decides the answer.
+    ASSERT_FALSE(digraph.VisitSimpleCycles(
+        [](const std::vector<int>& cycle) { return cycle.size() != 4; }, 4));
+}
+
 TEST(DirectedGraphTest, DeleteCyclesOfLength2) {
     std::vector<std::pair<int, int>> edges = {
         {0, 2}, {1, 0}, {2, 0}, {2, 3}, {2, 4}, {3, 1}, {3, 5}, {4, 5}, {5, 4}};
@@ -73,4 +124,127 @@ TEST(DirectedGraphTest, DeleteCyclesOfLength2) {
         {1, 0}, {2, 3}, {2, 4}, {3, 1}, {3, 5}};
     ASSERT_EQ(expected_edges, result.Edges());
 }
+
+TEST(DirectedGraphTest, EditEdges) {
+    DirectedGraph digraph({{0, 1}, {1, 2}, {2, 3}}, 4);
+    digraph.AddEdge(3, 1);
+    ASSERT_EQ(4, digraph.NumEdges());
+    ASSERT_FALSE(digraph.IsDAG());
+    ASSERT_EQ(2, digraph.StronglyConnectedComponents().size());
+
+    digraph.ReverseEdge(3, 1);
+    ASSERT_TRUE(digraph.IsDAG());
+    ASSERT_EQ(4, digraph.StronglyConnectedComponents().size());
+
+    digraph.RemoveEdge(1, 3);
+    std::vector<std::pair<int, int>> expected_edges = {{0, 1}, {1, 2}, {2, 3}};
+    ASSERT_EQ(expected_edges, digraph.Edges());
+    std::vector<int> expected_order = {0, 1, 2, 3};
+    ASSERT_EQ(expected_order, digraph.TopologicalOrder());
+
+    digraph.AddEdge(2, 2);
+    ASSERT_FALSE(digraph.IsDAG());
+    digraph.RemoveEdge(2, 2);
+    ASSERT_TRUE(digraph.IsDAG());
+
+    ASSERT_THROW(digraph.RemoveEdge(3, 0), std::invalid_argument);
+}
+
+TEST(DirectedGraphTest, EditEdgesMatchesRebuild) {
+    const int n = 9;
+    DirectedGraph digraph({}, n);
+    unsigned int seed = 12345;
+    auto random = [&seed](int bound) {
+        seed = seed * 1103515245 + 12345;
+        return static_cast<int>((seed >> 16) % bound);
+    };
+
+    for (int step = 0; step < 2000; ++step) {
+        std::vector<std::pair<int, int>> edges = digraph.Edges();
+        if (edges.empty() || random(3) > 0) {
+            digraph.AddEdge(random(n), random(n));
+        } else {
+            std::pair<int, int> edge = edges[random(edges.size())];
+            if (random(2) == 0) {
+                digraph.RemoveEdge(edge.first, edge.second);
+            } else {
+                digraph.ReverseEdge(edge.first, edge.second);
+            }
+        }
+        if (digraph.NumEdges() > 14) {
+            std::pair<int, int> edge = digraph.Edges()[0];
+            digraph.RemoveEdge(edge.first, edge.second);
+        }
+
+        DirectedGraph rebuilt(digraph.Edges(), n);
+        ASSERT_EQ(rebuilt.IsDAG(), digraph.IsDAG());
+
+        // Same partition into components, and edges go forward in order.
+        std::vector<std::vector<int>> components =
+            digraph.StronglyConnectedComponents();
+        std::vector<std::vector<int>> expected_components =
+            rebuilt.StronglyConnectedComponents();
+        ASSERT_EQ(expected_components.size(), components.size());
+        std::vector<int> component_of(n);
+        std::vector<int> expected_component_of(n);
+        for (int i = 0; i < components.size(); ++i) {
+            for (auto& vertex : components[i]) {
+                component_of[vertex] = i;
+            }
+            for (auto& vertex : expected_components[i]) {
+                expected_component_of[vertex] = i;
+            }
+        }
+        for (int u = 0; u < n; ++u) {
+            for (int v = 0; v < n; ++v) {
+                ASSERT_EQ(expected_component_of[u] == expected_component_of[v],
+                          component_of[u] == component_of[v]);
+            }
+        }
+        for (auto& edge : digraph.Edges()) {
+            ASSERT_LE(component_of[edge.first], component_of[edge.second]);
+        }
+    }
+}
+
+TEST(DirectedGraphTest, Reorder) {
+    const std::vector<std::pair<int, int>> edges = {
+        {0, 4}, {1, 4}, {4, 2}, {4, 3}, {3, 5}};
+    DirectedGraph digraph(edges, 6);
+
+    ASSERT_EQ(std::vector<int>({0, 4, 2, 3, 1, 5}),
+              digraph.VertexOrdering(VertexOrder::kBreadthFirst));
+    ASSERT_EQ(std::vector<int>({5, 3, 1, 2, 4, 0}),
+              digraph.VertexOrdering(VertexOrder::kReverseCuthillMcKee));
+
+    for (auto order :
+         {VertexOrder::kTopological, VertexOrder::kBreadthFirst,
+          VertexOrder::kReverseCuthillMcKee}) {
+        RelabeledGraph relabeled = digraph.Reorder(order);
+        for (int vertex = 0; vertex < 6; ++vertex) {
+            ASSERT_EQ(vertex, relabeled.original_number[relabeled.new_number
+                                                            [vertex]]);
+        }
+
+        std::vector<std::pair<int, int>> expected_edges;
+        for (auto& edge : edges) {
+            expected_edges.push_back({relabeled.new_number[edge.first],
+                                      relabeled.new_number[edge.second]});
+        }
+        std::vector<std::pair<int, int>> relabeled_edges =
+            relabeled.graph.Edges();
+        std::sort(expected_edges.begin(), expected_edges.end());
+        std::sort(relabeled_edges.begin(), relabeled_edges.end());
+        ASSERT_EQ(expected_edges, relabeled_edges);
+
+        if (order == VertexOrder::kTopological) {
+            for (auto& edge : relabeled_edges) {
+                ASSERT_LT(edge.first, edge.second);
+            }
+        }
+    }
+
+    ASSERT_THROW(digraph.Relabel({0, 1, 2, 3, 4}), std::invalid_argument);
+    ASSERT_THROW(digraph.Relabel({0, 1, 2, 3, 4, 4}), std::invalid_argument);
+}
 }  // namespace FTMR
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include <sstream>
+#include <stdexcept>
+
+#include "edge_list_reader.hpp"
+#include "gtest/gtest.h"
+
+namespace FTMR {
+TEST(EdgeListReaderTest, ReadsRecords) {
+    std::stringstream input(
+        "\nGraph 1, order 3.\n3 2\n0 2  1 2\n\n4 3\n0 1\n1 2 2 3\n");
+    EdgeListReader reader(input);
+    EdgeListRecord record;
+
+    ASSERT_TRUE(reader.Next(record));
+    ASSERT_EQ(3, record.num_vertices);
+    const std::vector<std::pair<int, int>> expected1 = {{0, 2}, {1, 2}};
+    ASSERT_EQ(expected1, record.edges);
+
+    ASSERT_TRUE(reader.Next(record));
+    ASSERT_EQ(4, record.num_vertices);
+    const std::vector<std::pair<int, int>> expected2 = {
+        {0, 1}, {1, 2}, {2, 3}};
+    ASSERT_EQ(expected2, record.edges);
+
+    ASSERT_FALSE(reader.Next(record));
+}
+
+TEST(EdgeListReaderTest, MalformedRecord) {
+    std::stringstream truncated("3 2\n0 2 1\n");
+    EdgeListReader truncated_reader(truncated);
+    EdgeListRecord record;
+    ASSERT_THROW(truncated_reader.Next(record), std::runtime_error);
+
+    std::stringstream garbage("3 x\n");
+    EdgeListReader garbage_reader(garbage);
+    ASSERT_THROW(garbage_reader.Next(record), std::runtime_error);
+}
+
+TEST(EdgeListReaderTest, SkipRecord) {
+    std::stringstream input(
+        "3 x\n0 2 1 2\n\n2 1\n0 1\nGraph 3, order 3.\n3 2\n0 2 1 y\n"
+        "Graph 4, order 2.\n2 1\n1 0\n");
+    EdgeListReader reader(input);
+    EdgeListRecord record;
+    ASSERT_THROW(reader.Next(record), std::runtime_error);
+    reader.SkipRecord();
+    ASSERT_TRUE(reader.Next(record));
+    const std::vector<std::pair<int, int>> expected1 = {{0, 1}};
+    ASSERT_EQ(expected1, record.edges);
+
+    ASSERT_THROW(reader.Next(record), std::runtime_error);
+    reader.SkipRecord();
+    ASSERT_TRUE(reader.Next(record));
+    const std::vector<std::pair<int, int>> expected2 = {{1, 0}};
+    ASSERT_EQ(expected2, record.edges);
+    ASSERT_FALSE(reader.Next(record));
+}
+}  // namespace FTMR
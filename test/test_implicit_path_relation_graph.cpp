@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "implicit_path_relation_graph.hpp"
+#include "multitree_generator.hpp"
+#include "multitree_recolorability.hpp"
+
+namespace FTMR {
+TEST(ImplicitPathRelationGraphTest, Paths) {
+    const std::vector<std::pair<int, int>> edges = {
+        {0, 1}, {1, 2}, {1, 3}, {4, 3}, {3, 5}};
+    ImplicitPathRelationGraph prg(edges, 6);
+    ASSERT_EQ(16, prg.NumPaths());
+    for (int path_number = 0; path_number < prg.NumPaths(); ++path_number) {
+        std::pair<int, int> path = prg.GetPath(path_number);
+        ASSERT_EQ(path_number, prg.GetPathNumber(path.first, path.second));
+    }
+    ASSERT_EQ(-1, prg.GetPathNumber(2, 3));
+    ASSERT_TRUE(prg.IsReachable(0, 5));
+    ASSERT_FALSE(prg.IsReachable(5, 5));
+    ASSERT_EQ(prg.GetPathNumber(1, 5),
+              prg.GetNextStepPathNumber(prg.GetPathNumber(0, 5)));
+}
+
+TEST(ImplicitPathRelationGraphTest, Neighbors) {
+    MultitreeGenerator generator(6, 1);
+    generator.Generate([](const std::vector<std::pair<int, int>>& edges,
+                          int thread_index) {
+        ImplicitPathRelationGraph prg(edges, 6);
+        for (int path_number = 0; path_number < prg.NumPaths();
+             ++path_number) {
+            std::vector<int> adjacent_paths;
+            std::vector<int> reverse_adjacent_paths;
+            ImplicitPathRelationGraph::NeighborCursor cursor;
+            int neighbor;
+            while (prg.NextAdjacentPath(path_number, cursor, neighbor)) {
+                adjacent_paths.push_back(neighbor);
+            }
+            cursor = ImplicitPathRelationGraph::NeighborCursor();
+            while (prg.NextReverseAdjacentPath(path_number, cursor, neighbor)) {
+                reverse_adjacent_paths.push_back(neighbor);
+            }
+            std::sort(adjacent_paths.begin(), adjacent_paths.end());
+            std::sort(reverse_adjacent_paths.begin(),
+                      reverse_adjacent_paths.end());
+
+            std::vector<int> expected_adjacent_paths;
+            std::vector<int> expected_reverse_adjacent_paths;
+            for (int other = 0; other < prg.NumPaths(); ++other) {
+                if (prg.IsAdjacent(path_number, other)) {
+                    expected_adjacent_paths.push_back(other);
+                }
+                if (prg.IsAdjacent(other, path_number)) {
+                    expected_reverse_adjacent_paths.push_back(other);
+                }
+            }
+            ASSERT_EQ(expected_adjacent_paths, adjacent_paths);
+            ASSERT_EQ(expected_reverse_adjacent_paths, reverse_adjacent_paths);
+        }
+    });
+}
+
+TEST(ImplicitPathRelationGraphTest, ConditionsMatchExplicitGraph) {
+    for (int num_vertices = 2; num_vertices <= 7; ++num_vertices) {
+        MultitreeGenerator generator(num_vertices, 1);
+        generator.Generate([num_vertices](
+                               const std::vector<std::pair<int, int>>& edges,
+                               int thread_index) {
+            MultitreeRecolorability multitree(edges, num_vertices);
+            ImplicitPathRelationGraph prg(edges, num_vertices);
+            ASSERT_EQ(multitree.CheckConditionCP(), prg.CheckConditionCP());
+            ASSERT_EQ(multitree.CheckConditionCVPolynomial(),
+                      prg.CheckConditionCV());
+        });
+    }
+}
+
+TEST(ImplicitPathRelationGraphTest, LargeMultitree) {
+    // A directed path with a pendant edge at every vertex, alternating in
+    // and out.
+    const int length = 40;
+    std::vector<std::pair<int, int>> edges;
+    for (int i = 0; i + 1 < length; ++i) {
+        edges.push_back({i, i + 1});
+    }
+    for (int i = 0; i < length; ++i) {
+        if (i % 2 == 0) {
+            edges.push_back({i, length + i});
+        } else {
+            edges.push_back({length + i, i});
+        }
+    }
+    ImplicitPathRelationGraph prg(edges, 2 * length);
+    ASSERT_FALSE(prg.CheckConditionCP());
+    ASSERT_FALSE(prg.CheckConditionCV());
+}
+}  // namespace FTMR
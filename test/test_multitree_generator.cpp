@@ -0,0 +1,81 @@
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "directed_graph.hpp"
+#include "gtest/gtest.h"
+#include "multitree_generator.hpp"
+
+namespace FTMR {
+TEST(MultitreeGeneratorTest, NumberOfMultitrees) {
+    const std::vector<long long> expected = {1, 1, 3, 9, 34, 147, 771};
+    for (int num_vertices = 1; num_vertices <= 7; ++num_vertices) {
+        MultitreeGenerator generator(num_vertices, 1);
+        long long count = generator.Generate(
+            [](const std::vector<std::pair<int, int>>& edges,
+               int thread_index) {});
+        ASSERT_EQ(expected[num_vertices - 1], count);
+    }
+}
+
+TEST(MultitreeGeneratorTest, NumberOfPolytrees) {
+    // Oriented trees, OEIS A000238
+    const std::vector<long long> expected = {1, 1, 3, 8, 27, 91, 350};
+    for (int num_vertices = 1; num_vertices <= 7; ++num_vertices) {
+        MultitreeGenerator generator(num_vertices, 1);
+        long long num_polytrees = 0;
+        generator.Generate([&](const std::vector<std::pair<int, int>>& edges,
+                               int thread_index) {
+            if (edges.size() == num_vertices - 1) {
+                ++num_polytrees;
+            }
+        });
+        ASSERT_EQ(expected[num_vertices - 1], num_polytrees);
+    }
+}
+
+TEST(MultitreeGeneratorTest, GeneratesMultitrees) {
+    MultitreeGenerator generator(7, 1);
+    generator.Generate([](const std::vector<std::pair<int, int>>& edges,
+                          int thread_index) {
+        DirectedGraph digraph(edges, 7);
+        ASSERT_TRUE(digraph.IsDAG());
+
+        // Count the paths from each vertex by DFS.
+        for (int start_vertex = 0; start_vertex < 7; ++start_vertex) {
+            std::vector<int> num_paths(7, 0);
+            std::vector<int> stack = {start_vertex};
+            while (!stack.empty()) {
+                int vertex = stack.back();
+                stack.pop_back();
+                ++num_paths[vertex];
+                for (auto& adjacent_vertex : digraph.AdjacentVertices(vertex)) {
+                    stack.push_back(adjacent_vertex);
+                }
+            }
+            for (auto& count : num_paths) {
+                ASSERT_LE(count, 1);
+            }
+        }
+    });
+}
+
+TEST(MultitreeGeneratorTest, ThreadsPartitionSearchTree) {
+    std::set<std::vector<std::pair<int, int>>> single_thread;
+    MultitreeGenerator(8, 1).Generate(
+        [&](const std::vector<std::pair<int, int>>& edges, int thread_index) {
+            single_thread.insert(edges);
+        });
+
+    std::mutex mutex;
+    std::set<std::vector<std::pair<int, int>>> multi_thread;
+    long long count = MultitreeGenerator(8, 3).Generate(
+        [&](const std::vector<std::pair<int, int>>& edges, int thread_index) {
+            std::lock_guard<std::mutex> lock(mutex);
+            multi_thread.insert(edges);
+        });
+
+    ASSERT_EQ(4813, count);
+    ASSERT_EQ(single_thread, multi_thread);
+}
+}  // namespace FTMR
@@ -1,8 +1,9 @@
 #include "gtest/gtest.h"
+#include "multitree_generator.hpp"
 #include "multitree_recolorability.hpp"
+#include "trees_data.hpp"
 
 namespace FTMR {
-
 TEST(MultitreeRecolorabilityTest, ConditionS) {
     const std::vector<std::pair<int, int>> edges1 = {
         {0, 1}, {0, 2}, {2, 4}, {3, 2}, {4, 5}, {4, 6}, {7, 6}};
@@ -52,4 +53,183 @@ TEST(MultitreeRecolorabilityTest, ConditionCV) {
     MultitreeRecolorability not_satisfyingCV(edges2, 8);
     ASSERT_FALSE(not_satisfyingCV.CheckConditionCV());
 }
-}  // namespace FTMR
\ No newline at end of file
+
+TEST(MultitreeRecolorabilityTest, ConditionCVPolynomial) {
+    const std::vector<std::pair<int, int>> edges1 = {
+        {0, 1}, {1, 2}, {3, 1}, {4, 2}, {0, 5},
+        {5, 7}, {5, 6}, {8, 6}, {9, 4}, {9, 8}};
+    MultitreeRecolorability satisfyingCV(edges1, 10);
+    ASSERT_TRUE(satisfyingCV.CheckConditionCVPolynomial());
+
+    const std::vector<std::pair<int, int>> edges2 = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}, {2, 6}, {7, 3}};
+    MultitreeRecolorability not_satisfyingCV(edges2, 8);
+    ASSERT_FALSE(not_satisfyingCV.CheckConditionCVPolynomial());
+}
+
+TEST(MultitreeRecolorabilityTest, ConditionCVPolynomialMatchesCV) {
+    for (int num_vertices = 4; num_vertices <= 8; ++num_vertices) {
+        auto trees_list = ReadTreesData(num_vertices);
+        ASSERT_FALSE(trees_list.empty());
+        for (auto &edges : trees_list) {
+            for (int flip_bits = 0; flip_bits < (1 << (num_vertices - 1));
+                 ++flip_bits) {
+                std::vector<std::pair<int, int>> polytree(edges);
+                for (int i = 0; i < num_vertices - 1; ++i) {
+                    if (flip_bits & (1 << i)) {
+                        std::swap(polytree[i].first, polytree[i].second);
+                    }
+                }
+                MultitreeRecolorability multitree(polytree, num_vertices);
+                ASSERT_EQ(multitree.CheckConditionCV(),
+                          multitree.CheckConditionCVPolynomial());
+            }
+        }
+    }
+}
+
+TEST(MultitreeRecolorabilityTest, ConditionCPBitParallelMatchesCP) {
+    for (int num_vertices = 4; num_vertices <= 8; ++num_vertices) {
+        auto trees_list = ReadTreesData(num_vertices);
+        ASSERT_FALSE(trees_list.empty());
+        for (auto &edges : trees_list) {
+            for (int flip_bits = 0; flip_bits < (1 << (num_vertices - 1));
+                 ++flip_bits) {
+                std::vector<std::pair<int, int>> polytree(edges);
+                for (int i = 0; i < num_vertices - 1; ++i) {
+                    if (flip_bits & (1 << i)) {
+                        std::swap(polytree[i].first, polytree[i].second);
+                    }
+                }
+                MultitreeRecolorability multitree(polytree, num_vertices);
+                ASSERT_EQ(multitree.CheckConditionCP(),
+                          multitree.CheckConditionCPBitParallel());
+            }
+        }
+    }
+
+    MultitreeGenerator generator(7, 1);
+    generator.Generate([](const std::vector<std::pair<int, int>> &edges,
+                          int thread_index) {
+        MultitreeRecolorability multitree(edges, 7);
+        ASSERT_EQ(multitree.CheckConditionCP(),
+                  multitree.CheckConditionCPBitParallel());
+    });
+}
+
+TEST(MultitreeRecolorabilityTest, ConditionCVParallel) {
+    const int num_vertices = 9;
+    auto trees_list = ReadTreesData(num_vertices);
+    ASSERT_FALSE(trees_list.empty());
+    int num_not_cv = 0;
+    for (auto &edges : trees_list) {
+        for (int flip_bits = 0; flip_bits < (1 << (num_vertices - 1));
+             ++flip_bits) {
+            std::vector<std::pair<int, int>> polytree(edges);
+            for (int i = 0; i < num_vertices - 1; ++i) {
+                if (flip_bits & (1 << i)) {
+                    std::swap(polytree[i].first, polytree[i].second);
+                }
+            }
+            MultitreeRecolorability multitree(polytree, num_vertices);
+            bool condition_cv = multitree.CheckConditionCVPolynomial();
+            ASSERT_EQ(condition_cv, multitree.CheckConditionCV(3));
+            num_not_cv += condition_cv ? 0 : 1;
+        }
+    }
+    ASSERT_EQ(36, num_not_cv);
+}
+
+TEST(MultitreeRecolorabilityTest, RelabeledMatches) {
+    MultitreeGenerator generator(6, 1);
+    generator.Generate([](const std::vector<std::pair<int, int>> &edges,
+                          int thread_index) {
+        MultitreeRecolorability multitree(edges, 6);
+        for (auto order :
+             {VertexOrder::kTopological, VertexOrder::kBreadthFirst,
+              VertexOrder::kReverseCuthillMcKee}) {
+            MultitreeRecolorability relabeled(DirectedGraph(edges, 6), order);
+            for (int u = 0; u < 6; ++u) {
+                for (int v = 0; v < 6; ++v) {
+                    ASSERT_EQ(multitree.IsReachable(u, v),
+                              relabeled.IsReachable(u, v));
+                }
+            }
+            ASSERT_EQ(multitree.CheckConditionS(),
+                      relabeled.CheckConditionS());
+            ASSERT_EQ(multitree.CheckConditionCP(),
+                      relabeled.CheckConditionCP());
+            ASSERT_EQ(multitree.CheckConditionCVPolynomial(),
+                      relabeled.CheckConditionCVPolynomial());
+        }
+    });
+}
+
+// The n = 6 multitrees are too small to show every difference between the
+// vertex numbers of the input and of the relabeled multitree in (CP).
+TEST(MultitreeRecolorabilityTest, RelabeledMatchesOnPolytrees) {
+    const int num_vertices = 9;
+    auto trees_list = ReadTreesData(num_vertices);
+    ASSERT_FALSE(trees_list.empty());
+    int num_not_s = 0;
+    for (auto &edges : trees_list) {
+        PolytreeSkeleton skeleton(edges, num_vertices);
+        for (uint64_t flip_bits = 0; flip_bits < skeleton.NumOrientations();
+             ++flip_bits) {
+            if (MultitreeRecolorability(skeleton, flip_bits)
+                    .CheckConditionS()) {
+                continue;
+            }
+            ++num_not_s;
+
+            std::vector<std::pair<int, int>> polytree;
+            for (int i = 0; i < num_vertices - 1; ++i) {
+                polytree.push_back(skeleton.GetEdge(i, flip_bits));
+            }
+            MultitreeRecolorability multitree(polytree, num_vertices);
+            bool condition_cp = multitree.CheckConditionCP();
+            bool condition_cv = multitree.CheckConditionCVPolynomial();
+            for (auto order :
+                 {VertexOrder::kTopological, VertexOrder::kBreadthFirst,
+                  VertexOrder::kReverseCuthillMcKee}) {
+                MultitreeRecolorability relabeled(
+                    DirectedGraph(polytree, num_vertices), order);
+                ASSERT_FALSE(relabeled.CheckConditionS());
+                ASSERT_EQ(condition_cp, relabeled.CheckConditionCP());
+                ASSERT_EQ(condition_cp,
+                          relabeled.CheckConditionCPBitParallel());
+                ASSERT_EQ(condition_cv,
+                          relabeled.CheckConditionCVPolynomial());
+            }
+        }
+    }
+    ASSERT_EQ(2360, num_not_s);
+}
+
+TEST(MultitreeRecolorabilityTest, SkeletonMatches) {
+    for (int num_vertices = 4; num_vertices <= 8; ++num_vertices) {
+        auto trees_list = ReadTreesData(num_vertices);
+        ASSERT_FALSE(trees_list.empty());
+        for (auto &edges : trees_list) {
+            PolytreeSkeleton skeleton(edges, num_vertices);
+            for (uint64_t flip_bits = 0;
+                 flip_bits < skeleton.NumOrientations(); ++flip_bits) {
+                std::vector<std::pair<int, int>> polytree;
+                for (int i = 0; i < num_vertices - 1; ++i) {
+                    polytree.push_back(skeleton.GetEdge(i, flip_bits));
+                }
+                MultitreeRecolorability multitree(polytree, num_vertices);
+                MultitreeRecolorability from_skeleton(skeleton, flip_bits);
+                ASSERT_EQ(multitree.CheckConditionS(),
+                          from_skeleton.CheckConditionS());
+                ASSERT_EQ(multitree.CheckConditionCP(),
+                          from_skeleton.CheckConditionCP());
+                ASSERT_EQ(multitree.CheckConditionCPBitParallel(),
+                          from_skeleton.CheckConditionCPBitParallel());
+                ASSERT_EQ(multitree.CheckConditionCVPolynomial(),
+                          from_skeleton.CheckConditionCVPolynomial());
+            }
+        }
+    }
+}
+}  // namespace FTMR
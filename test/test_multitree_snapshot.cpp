@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "multitree_generator.hpp"
+#include "multitree_recolorability.hpp"
+#include "multitree_snapshot.hpp"
+
+namespace FTMR {
+
+TEST(MultitreeSnapshotTest, WriteAndMap) {
+    const std::vector<std::pair<int, int>> edges = {
+        {0, 1}, {1, 2}, {1, 3}, {4, 3}, {3, 5}};
+    MultitreeRecolorability multitree(edges, 6);
+    std::string filename = testing::TempDir() + "multitree_snapshot_test.bin";
+    multitree.WriteSnapshot(filename);
+
+    MultitreeSnapshot snapshot(filename);
+    ASSERT_EQ(6, snapshot.NumVertices());
+    ASSERT_EQ(2, snapshot.Multitree().RowSize(1));
+    ASSERT_EQ(2u, snapshot.Multitree().RowBegin(1)[0]);
+    ASSERT_EQ(3u, snapshot.Multitree().RowBegin(1)[1]);
+    ASSERT_EQ(std::make_pair(0, 0), snapshot.GetPath(0));
+
+    MultitreeRecolorability loaded(snapshot);
+    ASSERT_FALSE(loaded.CheckConditionS());
+    ASSERT_EQ(multitree.CheckConditionCP(), loaded.CheckConditionCP());
+    ASSERT_EQ(multitree.CheckConditionCV(), loaded.CheckConditionCV());
+    std::remove(filename.c_str());
+}
+
+TEST(MultitreeSnapshotTest, LoadedStateMatches) {
+    std::string filename = testing::TempDir() + "multitree_snapshot_test.bin";
+    MultitreeGenerator generator(6, 1);
+    generator.Generate([&filename](
+                           const std::vector<std::pair<int, int>>& edges,
+                           int thread_index) {
+        MultitreeRecolorability multitree(edges, 6);
+        multitree.WriteSnapshot(filename);
+        MultitreeSnapshot snapshot(filename);
+        MultitreeRecolorability loaded(snapshot);
+
+        for (int u = 0; u < 6; ++u) {
+            for (int v = 0; v < 6; ++v) {
+                ASSERT_EQ(multitree.IsReachable(u, v),
+                          loaded.IsReachable(u, v));
+            }
+        }
+        ASSERT_EQ(multitree.CheckConditionS(), loaded.CheckConditionS());
+        ASSERT_EQ(multitree.CheckConditionCycle(),
+                  loaded.CheckConditionCycle());
+        ASSERT_EQ(multitree.CheckConditionCP(), loaded.CheckConditionCP());
+        ASSERT_EQ(multitree.CheckConditionCVPolynomial(),
+                  loaded.CheckConditionCVPolynomial());
+    });
+    std::remove(filename.c_str());
+}
+
+TEST(MultitreeSnapshotTest, RelabeledStateUsesInputNumbers) {
+    const std::vector<std::pair<int, int>> edges = {
+        {5, 1}, {1, 2}, {1, 3}, {4, 3}, {3, 0}};
+    MultitreeRecolorability multitree(DirectedGraph(edges, 6),
+                                      VertexOrder::kReverseCuthillMcKee);
+    std::string filename = testing::TempDir() + "multitree_snapshot_test.bin";
+    multitree.WriteSnapshot(filename);
+
+    MultitreeSnapshot snapshot(filename);
+    MultitreeRecolorability loaded(snapshot);
+    for (int u = 0; u < 6; ++u) {
+        for (int v = 0; v < 6; ++v) {
+            ASSERT_EQ(multitree.IsReachable(u, v), loaded.IsReachable(u, v));
+        }
+    }
+    ASSERT_TRUE(loaded.IsReachable(5, 0));
+    std::remove(filename.c_str());
+}
+
+TEST(MultitreeSnapshotTest, RejectsInvalidFiles) {
+    std::string filename = testing::TempDir() + "multitree_snapshot_test.bin";
+    ASSERT_THROW(MultitreeSnapshot(filename + ".missing"), std::runtime_error);
+
+    const std::vector<std::pair<int, int>> edges = {{0, 1}, {1, 2}};
+    MultitreeRecolorability(edges, 3).WriteSnapshot(filename);
+    std::string contents;
+    {
+        std::ifstream file(filename, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file),
+                        std::istreambuf_iterator<char>());
+    }
+
+    // Truncated.
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file.write(contents.data(), contents.size() - 8);
+    }
+    ASSERT_THROW(MultitreeSnapshot snapshot(filename), std::runtime_error);
+
+    // Wrong magic.
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file.write("FTMRTREE", 8);
+        file.write(contents.data() + 8, contents.size() - 8);
+    }
+    ASSERT_THROW(MultitreeSnapshot snapshot(filename), std::runtime_error);
+
+    // Vertex out of range in the last edge of the path relation graph.
+    {
+        std::string corrupted(contents);
+        corrupted[corrupted.size() - 8] = 100;
+        std::ofstream file(filename, std::ios::binary);
+        file.write(corrupted.data(), corrupted.size());
+    }
+    ASSERT_THROW(MultitreeSnapshot snapshot(filename), std::runtime_error);
+    std::remove(filename.c_str());
+}
+}  // namespace FTMR
@@ -0,0 +1,137 @@
+#include <bitset>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "multitree_recolorability.hpp"
+#include "polytree_orientations.hpp"
+#include "trees_data.hpp"
+
+namespace FTMR {
+TEST(TreeOrientationsTest, InvalidTree) {
+    ASSERT_THROW(TreeOrientations({{0, 1}, {1, 0}}, 3), std::invalid_argument);
+    ASSERT_THROW(TreeOrientations({{0, 1}}, 3), std::invalid_argument);
+}
+
+TEST(TreeOrientationsTest, ConditionSMatchesMultitreeRecolorability) {
+    for (int num_vertices = 4; num_vertices <= 8; ++num_vertices) {
+        auto trees_list = ReadTreesData(num_vertices);
+        ASSERT_FALSE(trees_list.empty());
+        for (auto& edges : trees_list) {
+            TreeOrientations orientations(edges, num_vertices);
+            for (uint64_t first = 0; first < orientations.NumOrientations();
+                 first += 256) {
+                uint64_t masks[4];
+                orientations.ConditionSMasks(first, masks);
+                for (int w = 0; w < 4; ++w) {
+                    ASSERT_EQ(orientations.ConditionSMask(first + 64 * w),
+                              masks[w]);
+                }
+
+                for (uint64_t lane = 0; lane < 256; ++lane) {
+                    uint64_t flip_bits = first + lane;
+                    if (flip_bits >= orientations.NumOrientations()) {
+                        ASSERT_EQ(0, (masks[lane / 64] >> (lane % 64)) & 1);
+                        continue;
+                    }
+
+                    std::vector<std::pair<int, int>> polytree(edges);
+                    for (int i = 0; i < num_vertices - 1; ++i) {
+                        if ((flip_bits >> i) & 1) {
+                            std::swap(polytree[i].first, polytree[i].second);
+                        }
+                    }
+                    MultitreeRecolorability multitree(polytree, num_vertices);
+                    ASSERT_EQ(multitree.CheckConditionS(),
+                              (masks[lane / 64] >> (lane % 64)) & 1);
+                }
+            }
+        }
+    }
+}
+
+TEST(TreeOrientationsTest, NumberOfOrientationsSatisfyingS) {
+    const std::vector<long long> expected = {9672, 39704, 162472};
+    for (int num_vertices = 9; num_vertices <= 11; ++num_vertices) {
+        long long num_s = 0;
+        for (auto& edges : ReadTreesData(num_vertices)) {
+            TreeOrientations orientations(edges, num_vertices);
+            for (uint64_t first = 0; first < orientations.NumOrientations();
+                 first += 64) {
+                num_s +=
+                    std::bitset<64>(orientations.ConditionSMask(first)).count();
+            }
+        }
+        ASSERT_EQ(expected[num_vertices - 9], num_s);
+    }
+}
+
+TEST(TreeOrientationsTest, CountConditionS) {
+    for (int num_vertices = 4; num_vertices <= 11; ++num_vertices) {
+        for (auto& edges : ReadTreesData(num_vertices)) {
+            TreeOrientations orientations(edges, num_vertices);
+            uint64_t num_tree_s = 0;
+            for (uint64_t first = 0; first < orientations.NumOrientations();
+                 first += 64) {
+                num_tree_s +=
+                    std::bitset<64>(orientations.ConditionSMask(first)).count();
+            }
+            ASSERT_EQ(num_tree_s, orientations.CountConditionS());
+        }
+    }
+
+    // Only the center of a star can split or merge, so every orientation
+    // satisfies (S), and the count of the largest star needs all 63 bits.
+    std::vector<std::pair<int, int>> star;
+    for (int i = 1; i < 64; ++i) {
+        star.push_back({0, i});
+    }
+    TreeOrientations star_orientations(star, 64);
+    ASSERT_EQ(star_orientations.NumOrientations(),
+              star_orientations.CountConditionS());
+    ASSERT_EQ(1, TreeOrientations({}, 1).CountConditionS());
+}
+
+TEST(PolytreeSkeletonTest, Paths) {
+    // 0 - 1 - 2 - 3 with 4 hanging from 1.
+    const std::vector<std::pair<int, int>> edges = {
+        {0, 1}, {2, 1}, {2, 3}, {4, 1}};
+    PolytreeSkeleton skeleton(edges, 5);
+    ASSERT_EQ(std::vector<int>({3, 2, 1, 4}), skeleton.Path(3, 4));
+    ASSERT_EQ(std::vector<int>({0}), skeleton.Path(0, 0));
+    ASSERT_EQ(0b1110u, skeleton.PathEdges(3, 4));
+    ASSERT_EQ(1, skeleton.LowestCommonAncestor(3, 4));
+    ASSERT_EQ(2, skeleton.LowestCommonAncestor(2, 3));
+    ASSERT_EQ(3, skeleton.Depth(3));
+
+    ASSERT_TRUE(skeleton.Reaches(2, 1, 0));
+    ASSERT_FALSE(skeleton.Reaches(3, 1, 0));
+    ASSERT_TRUE(skeleton.Reaches(3, 1, 0b100));
+    ASSERT_EQ(3, skeleton.InDegree(1, 0));
+    ASSERT_EQ(1, skeleton.OutDegree(1, 0b10));
+    ASSERT_EQ(std::make_pair(1, 2), skeleton.GetEdge(1, 0b10));
+
+    ASSERT_THROW(PolytreeSkeleton({{0, 1}, {1, 0}}, 3), std::invalid_argument);
+}
+
+TEST(PolytreeSkeletonTest, ReachesMatchesMultitreeRecolorability) {
+    for (int num_vertices = 4; num_vertices <= 7; ++num_vertices) {
+        for (auto& edges : ReadTreesData(num_vertices)) {
+            PolytreeSkeleton skeleton(edges, num_vertices);
+            for (uint64_t flip_bits = 0;
+                 flip_bits < skeleton.NumOrientations(); ++flip_bits) {
+                std::vector<std::pair<int, int>> polytree;
+                for (int i = 0; i < num_vertices - 1; ++i) {
+                    polytree.push_back(skeleton.GetEdge(i, flip_bits));
+                }
+                MultitreeRecolorability multitree(polytree, num_vertices);
+                for (int u = 0; u < num_vertices; ++u) {
+                    for (int v = 0; v < num_vertices; ++v) {
+                        ASSERT_EQ(multitree.IsReachable(u, v),
+                                  u != v && skeleton.Reaches(u, v, flip_bits));
+                    }
+                }
+            }
+        }
+    }
+}
+}  // namespace FTMR
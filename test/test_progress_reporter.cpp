@@ -0,0 +1,59 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "progress_reporter.hpp"
+
+namespace FTMR {
+namespace {
+std::string ReadFile(const std::string& filename) {
+    std::ifstream file(filename);
+    return std::string(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+}
+}  // namespace
+
+TEST(ProgressReporterTest, StatusFile) {
+    std::string status_file = ::testing::TempDir() + "ftmr_progress.json";
+    std::remove(status_file.c_str());
+
+    ProgressReporter progress("items", {"A", "B"}, 4, 8000,
+                              std::chrono::milliseconds(1), false,
+                              status_file);
+    progress.Start();
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < 4; ++worker) {
+        workers.emplace_back([&progress, worker]() {
+            for (int i = 0; i < 1000; ++i) {
+                progress.Add(worker, 0);
+                progress.Add(worker, 1);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    progress.Stop();
+
+    std::string status = ReadFile(status_file);
+    ASSERT_NE(status.find("\"done\": 8000"), std::string::npos);
+    ASSERT_NE(status.find("\"total\": 8000"), std::string::npos);
+    ASSERT_NE(status.find("\"percent\": 100.000"), std::string::npos);
+    ASSERT_NE(status.find("\"finished\": true"), std::string::npos);
+    ASSERT_NE(status.find("\"counts\": {\"A\": 4000, \"B\": 4000}"),
+              std::string::npos);
+    std::remove(status_file.c_str());
+}
+
+TEST(ProgressReporterTest, InvalidWorkers) {
+    ASSERT_THROW(ProgressReporter("items", {"A"}, 0, 0,
+                                  std::chrono::milliseconds(1), false, ""),
+                 std::invalid_argument);
+}
+}  // namespace FTMR
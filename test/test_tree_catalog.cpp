@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "tree_catalog.hpp"
+
+namespace FTMR {
+namespace {
+std::vector<int> SortedDegrees(const std::vector<std::pair<int, int>>& edges,
+                               int num_vertices) {
+    std::vector<int> degrees(num_vertices, 0);
+    for (auto& edge : edges) {
+        ++degrees[edge.first];
+        ++degrees[edge.second];
+    }
+    std::sort(degrees.begin(), degrees.end());
+    return degrees;
+}
+}  // namespace
+
+TEST(TreeCatalogTest, EncodeAndDecode) {
+    const std::vector<std::pair<int, int>> edges = {
+        {0, 6}, {1, 6}, {2, 1}, {3, 2}, {4, 1}, {5, 6}};
+    uint64_t code = EncodeTree(edges, 7);
+
+    std::vector<std::pair<int, int>> decoded(6);
+    ASSERT_TRUE(DecodeTree(code, 7, decoded.data()));
+    ASSERT_EQ(edges, decoded);
+    ASSERT_EQ(code, EncodeTree(decoded, 7));
+}
+
+TEST(TreeCatalogTest, LongestPathFitsInOneWord) {
+    std::vector<std::pair<int, int>> path;
+    for (int i = 0; i < kMaxTreeCatalogVertices - 1; ++i) {
+        path.push_back({i, i + 1});
+    }
+    uint64_t code = EncodeTree(path, kMaxTreeCatalogVertices);
+
+    std::vector<std::pair<int, int>> decoded(kMaxTreeCatalogVertices - 1);
+    ASSERT_TRUE(DecodeTree(code, kMaxTreeCatalogVertices, decoded.data()));
+    ASSERT_EQ(SortedDegrees(path, kMaxTreeCatalogVertices),
+              SortedDegrees(decoded, kMaxTreeCatalogVertices));
+    ASSERT_EQ(code, EncodeTree(decoded, kMaxTreeCatalogVertices));
+}
+
+TEST(TreeCatalogTest, RejectsNonTrees) {
+    const std::vector<std::pair<int, int>> cycle = {{0, 1}, {1, 2}, {2, 0}};
+    ASSERT_THROW(EncodeTree(cycle, 4), std::invalid_argument);
+    ASSERT_THROW(EncodeTree(cycle, 3), std::invalid_argument);
+}
+
+TEST(TreeCatalogTest, RejectsInvalidCodes) {
+    std::vector<std::pair<int, int>> decoded(4);
+    // Climbs above the root before the second vertex.
+    ASSERT_FALSE(DecodeTree(0b0110, 5, decoded.data()));
+    // Bits left over after the last vertex.
+    ASSERT_FALSE(DecodeTree(uint64_t(1) << 40, 5, decoded.data()));
+
+    std::string filename = testing::TempDir() + "tree_catalog_invalid.bin";
+    WriteTreeCatalog(filename, 5, {0, 0b0110});
+    TreeCatalogReader reader(filename);
+    ASSERT_TRUE(reader.Next(decoded));
+    ASSERT_THROW(reader.Next(decoded), std::runtime_error);
+    std::remove(filename.c_str());
+}
+
+TEST(TreeCatalogTest, WriteAndRead) {
+    const std::vector<std::vector<std::pair<int, int>>> trees = {
+        {{0, 4}, {1, 4}, {2, 4}, {3, 4}},
+        {{0, 3}, {0, 4}, {1, 4}, {2, 4}},
+        {{0, 1}, {1, 2}, {2, 3}, {3, 4}}};
+    std::vector<uint64_t> codes;
+    for (auto& tree : trees) {
+        codes.push_back(EncodeTree(tree, 5));
+    }
+
+    std::string filename = testing::TempDir() + "tree_catalog_test.bin";
+    WriteTreeCatalog(filename, 5, codes);
+
+    TreeCatalogReader reader(filename);
+    ASSERT_EQ(5, reader.NumVertices());
+    ASSERT_EQ(3, reader.NumTrees());
+
+    std::vector<std::pair<int, int>> edges(4);
+    for (auto& tree : trees) {
+        ASSERT_TRUE(reader.Next(edges));
+        ASSERT_EQ(SortedDegrees(tree, 5), SortedDegrees(edges, 5));
+    }
+    ASSERT_FALSE(reader.Next(edges));
+    std::remove(filename.c_str());
+}
+}  // namespace FTMR
@@ -0,0 +1,20 @@
+#include "trees_data.hpp"
+
+#include <fstream>
+#include <string>
+
+#include "edge_list_reader.hpp"
+
+namespace FTMR {
+std::vector<std::vector<std::pair<int, int>>> ReadTreesData(int num_vertices) {
+    std::vector<std::vector<std::pair<int, int>>> trees_list;
+    std::ifstream file(std::string(FTMR_TREES_DATA_DIR) + "trees_data_" +
+                       std::to_string(num_vertices) + ".txt");
+    EdgeListReader reader(file);
+    EdgeListRecord record;
+    while (reader.Next(record)) {
+        trees_list.push_back(record.edges);
+    }
+    return trees_list;
+}
+}  // namespace FTMR
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace FTMR {
+// Reads example/trees/trees_data_n.txt for the tests. Returns an empty list
+// if the file does not exist.
+std::vector<std::vector<std::pair<int, int>>> ReadTreesData(int num_vertices);
+}  // namespace FTMR